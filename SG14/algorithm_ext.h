@@ -1,5 +1,6 @@
 #pragma once
 #include <cassert>
+#include "compact_kernels.h"
 namespace stdext
 {
 	template<class T>
@@ -17,6 +18,17 @@ namespace stdext
 			++begin;
 		}
 	}
+	template<class ForwardIterator, class Size>
+	ForwardIterator destroy_n(ForwardIterator begin, Size n)
+	{
+		typedef typename std::iterator_traits<ForwardIterator>::value_type _T;
+		for (; n > 0; --n)
+		{
+			begin->~_T();
+			++begin;
+		}
+		return begin;
+	}
 
 
 	template<class InputIt, class FwdIt>
@@ -35,12 +47,33 @@ namespace stdext
 		}
 		catch (...)
 		{
-			destroy(Dst, current);
+			stdext::destroy(Dst, current);
 			throw;
 		}
 
 	}
 
+	template<class InputIt, class Size, class FwdIt>
+	FwdIt uninitialized_move_n(InputIt SrcBegin, Size Count, FwdIt Dst)
+	{
+		FwdIt current = Dst;
+		try
+		{
+			for (; Count > 0; --Count)
+			{
+				::new (static_cast<void*>(std::addressof(*current))) typename std::iterator_traits<FwdIt>::value_type(std::move(*SrcBegin));
+				++current;
+				++SrcBegin;
+			}
+			return current;
+		}
+		catch (...)
+		{
+			stdext::destroy(Dst, current);
+			throw;
+		}
+	}
+
 	template<class FwdIt>
 	FwdIt uninitialized_value_construct(FwdIt first, FwdIt last)
 	{
@@ -56,7 +89,7 @@ namespace stdext
 		}
 		catch (...)
 		{
-			destroy(first, current);
+			stdext::destroy(first, current);
 			throw;
 		}
 
@@ -77,7 +110,7 @@ namespace stdext
 		}
 		catch (...)
 		{
-			destroy(first, current);
+			stdext::destroy(first, current);
 			throw;
 		}
 	}
@@ -101,6 +134,35 @@ namespace stdext
 		return (first);
 	}
 
+	//unstable_remove_if that calls on_move(from, to) right after moving *from into *to
+	//lets indexes into the range, such as handle tables, be patched in the same pass
+	template<class BidirIt, class UnaryPredicate, class OnMove>
+	BidirIt unstable_remove_if_with_relocation(BidirIt first, BidirIt last, UnaryPredicate p, OnMove on_move)
+	{
+		for (; ; ++first)
+		{
+			for (; first != last && !p(*first); ++first);
+			if (first == last)
+				break;
+
+			for (; first != --last && p(*last); );
+			if (first == last)
+				break;
+
+			*first = std::move(*last);
+			on_move(last, first);
+		}
+
+		return (first);
+	}
+
+	//contiguous arithmetic, enum and pointer ranges go to the branchless and SIMD kernels in compact_kernels.h
+	template<class T, class UnaryPredicate>
+	std::enable_if_t<is_compactable<T>::value, T*> unstable_remove_if(T* first, T* last, UnaryPredicate p)
+	{
+		return detail_::unstable_remove_if_compact(first, last, p);
+	}
+
 	//this exists as a point of reference for providing a stable comparison vs unstable_remove_if
 	template<class BidirIt, class UnaryPredicate>
 	BidirIt partition(BidirIt first, BidirIt last, UnaryPredicate p)
@@ -133,6 +195,11 @@ namespace stdext
 					*first++ = move(*i);
 		return first;
 	}
+	template<class T, class UnaryPredicate>
+	std::enable_if_t<is_compactable<T>::value, T*> remove_if(T* first, T* last, UnaryPredicate p)
+	{
+		return detail_::remove_if_compact(first, last, p);
+	}
 	template<class FwdIt, class Pred>
 	auto semistable_partition(FwdIt first, FwdIt last, Pred p)
 	{
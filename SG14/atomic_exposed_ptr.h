@@ -0,0 +1,302 @@
+#pragma once
+#include "exposed_ptr.h"
+
+template<class T> class atomic_exposed_ptr;
+template<class T> class atomic_soft_ptr;
+
+namespace detail_
+{
+	//one word holds the whole state so every transition is a single atomic operation
+	//bits 0-31 count references to the block, the owner and each soft pointer and pin hold one
+	//bits 32-62 count pins, the object is destroyed by whoever leaves it invalid and unpinned
+	//bit 63 is set while the owner is alive
+	//only the thread that destroys the object takes a second one, it drops its own reference after ~T returns,
+	//so the block cannot be freed under it
+	template<class T>
+	struct atomic_softctrl
+	{
+		static constexpr uint64_t ref_one = 1;
+		static constexpr uint64_t pin_one = uint64_t(1) << 32;
+		static constexpr uint64_t valid_bit = uint64_t(1) << 63;
+		static constexpr uint64_t ref_mask = pin_one - 1;
+		static constexpr uint64_t pin_mask = valid_bit - pin_one;
+
+		std::atomic<uint64_t> state_;
+		std::aligned_union_t<0, T> value_;
+
+		T* object() noexcept(true)
+		{
+			return (T*)&value_;
+		}
+		void add_ref() noexcept(true)
+		{
+			state_.fetch_add(ref_one, std::memory_order_relaxed);
+		}
+		void release_ref() noexcept(true)
+		{
+			if (state_.fetch_sub(ref_one, std::memory_order_acq_rel) == ref_one)
+			{
+				free_block();
+			}
+		}
+		//takes a pin and a reference together, fails once the owner is gone
+		bool try_pin() noexcept(true)
+		{
+			auto state = state_.load(std::memory_order_relaxed);
+			do
+			{
+				if (!(state & valid_bit))
+				{
+					return false;
+				}
+			} while (!state_.compare_exchange_weak(state, state + pin_one + ref_one, std::memory_order_acquire, std::memory_order_relaxed));
+			return true;
+		}
+		void unpin() noexcept(true)
+		{
+			leave(pin_one);
+		}
+		//owner teardown
+		void expire() noexcept(true)
+		{
+			leave(valid_bit);
+		}
+		bool valid() const noexcept(true)
+		{
+			return (state_.load(std::memory_order_acquire) & valid_bit) != 0;
+		}
+		uint32_t soft_count() const noexcept(true)
+		{
+			return uint32_t(state_.load(std::memory_order_relaxed) & ref_mask);
+		}
+		void free_block() noexcept(true)
+		{
+			this->~atomic_softctrl();
+			block_pool<sizeof(atomic_softctrl), alignof(atomic_softctrl)>::local().release(this);
+		}
+	private:
+		//drops the valid bit or a pin together with the caller's reference in one compare exchange,
+		//unless that leaves the object invalid and unpinned, then the reference is kept until ~T has run
+		//while the object stays alive the owner or another pin still holds a reference, so the count cannot reach zero
+		void leave(uint64_t amount) noexcept(true)
+		{
+			auto state = state_.load(std::memory_order_relaxed);
+			uint64_t next;
+			do
+			{
+				next = state - amount;
+				if (next & (valid_bit | pin_mask))
+				{
+					next -= ref_one;
+				}
+			} while (!state_.compare_exchange_weak(state, next, std::memory_order_acq_rel, std::memory_order_relaxed));
+			if (!(next & (valid_bit | pin_mask)))
+			{
+				object()->~T();
+				release_ref();
+			}
+		}
+	};
+}
+
+//soft_pin: keeps the object behind an atomic_soft_ptr alive while in scope
+template<class T>
+class soft_pin
+{
+	detail_::atomic_softctrl<T>* ptr_ = nullptr;
+	friend class atomic_soft_ptr<T>;
+	explicit soft_pin(detail_::atomic_softctrl<T>* ctrl)
+		:ptr_(ctrl)
+	{}
+public:
+	soft_pin() = default;
+	soft_pin(const soft_pin&) = delete;
+	soft_pin(soft_pin&& a) noexcept(true)
+		:ptr_(a.ptr_)
+	{
+		a.ptr_ = nullptr;
+	}
+	soft_pin& operator=(soft_pin&& a) noexcept(true)
+	{
+		clear();
+		ptr_ = a.ptr_;
+		a.ptr_ = nullptr;
+		return *this;
+	}
+	T* get() const
+	{
+		return ptr_ ? ptr_->object() : nullptr;
+	}
+	T& operator*() const
+	{
+		return *get();
+	}
+	T* operator->() const
+	{
+		return get();
+	}
+	explicit operator bool() const { return ptr_ != nullptr; }
+	bool operator!() const { return ptr_ == nullptr; }
+	void clear()
+	{
+		if (!ptr_) return;
+		ptr_->unpin();
+		ptr_ = nullptr;
+	}
+	~soft_pin()
+	{
+		clear();
+	}
+};
+
+//atomic_soft_ptr: weak reference to an atomic_exposed_ptr that can be shared between threads
+//the object may only be touched through a soft_pin from lock()
+template<class T>
+class atomic_soft_ptr
+{
+	detail_::atomic_softctrl<T>* ptr_ = nullptr;
+	friend class atomic_exposed_ptr<T>;
+	explicit atomic_soft_ptr(detail_::atomic_softctrl<T>* ctrl)
+		:ptr_(ctrl)
+	{
+		if (ptr_) ptr_->add_ref();
+	}
+public:
+	atomic_soft_ptr() = default;
+	atomic_soft_ptr(nullptr_t) {}
+	atomic_soft_ptr(const atomic_exposed_ptr<T>& a)
+		:atomic_soft_ptr(a.ptr_)
+	{}
+	atomic_soft_ptr(const atomic_soft_ptr& a)
+		:atomic_soft_ptr(a.ptr_)
+	{}
+	atomic_soft_ptr(atomic_soft_ptr&& a) noexcept(true)
+		:ptr_(a.ptr_)
+	{
+		a.ptr_ = nullptr;
+	}
+	atomic_soft_ptr& operator=(const atomic_soft_ptr& a)
+	{
+		if (a.ptr_) a.ptr_->add_ref();
+		clear();
+		ptr_ = a.ptr_;
+		return *this;
+	}
+	atomic_soft_ptr& operator=(atomic_soft_ptr&& a) noexcept(true)
+	{
+		clear();
+		ptr_ = a.ptr_;
+		a.ptr_ = nullptr;
+		return *this;
+	}
+	atomic_soft_ptr& operator=(nullptr_t)
+	{
+		clear();
+		return *this;
+	}
+	//an empty pin once the owner has let go, a single compare exchange when uncontended
+	soft_pin<T> lock() const
+	{
+		return soft_pin<T>((ptr_ && ptr_->try_pin()) ? ptr_ : nullptr);
+	}
+	//only a hint, the owner may let go right after this returns true
+	bool expired() const
+	{
+		return !ptr_ || !ptr_->valid();
+	}
+	auto soft_count() const
+	{
+		return ptr_ ? ptr_->soft_count() : 0;
+	}
+	void clear()
+	{
+		if (!ptr_) return;
+		ptr_->release_ref();
+		ptr_ = nullptr;
+	}
+	~atomic_soft_ptr()
+	{
+		clear();
+	}
+	friend bool operator==(const atomic_soft_ptr& a, const atomic_soft_ptr& b)
+	{
+		return a.ptr_ == b.ptr_;
+	}
+	friend bool operator!=(const atomic_soft_ptr& a, const atomic_soft_ptr& b)
+	{
+		return a.ptr_ != b.ptr_;
+	}
+};
+
+//atomic_exposed_ptr: exposed_ptr whose soft references may be used from other threads
+//the owner itself is not shared, if a soft_pin is held when it lets go, the last pin runs ~T
+template<class T>
+class atomic_exposed_ptr
+{
+	detail_::atomic_softctrl<T>* ptr_ = nullptr;
+	friend class atomic_soft_ptr<T>;
+	using pool = detail_::block_pool<sizeof(detail_::atomic_softctrl<T>), alignof(detail_::atomic_softctrl<T>)>;
+public:
+	atomic_exposed_ptr() = default;
+	atomic_exposed_ptr(nullptr_t) {}
+	atomic_exposed_ptr(const atomic_exposed_ptr&) = delete;
+	atomic_exposed_ptr(atomic_exposed_ptr&& a) noexcept(true)
+		:ptr_(a.ptr_)
+	{
+		a.ptr_ = nullptr;
+	}
+	template<class... Args>
+	static atomic_exposed_ptr make(Args&&... args)
+	{
+		atomic_exposed_ptr result;
+		result.ptr_ = new(pool::local().allocate()) detail_::atomic_softctrl<T>();
+		new (&result.ptr_->value_) T(std::forward<Args>(args)...);
+		result.ptr_->state_.store(detail_::atomic_softctrl<T>::valid_bit | detail_::atomic_softctrl<T>::ref_one, std::memory_order_release);
+		return result;
+	}
+	atomic_exposed_ptr& operator=(atomic_exposed_ptr&& a) noexcept(true)
+	{
+		clear();
+		ptr_ = a.ptr_;
+		a.ptr_ = nullptr;
+		return *this;
+	}
+	atomic_exposed_ptr& operator=(nullptr_t)
+	{
+		clear();
+		return *this;
+	}
+	T* get() const
+	{
+		return ptr_ ? ptr_->object() : nullptr;
+	}
+	T& operator*() const
+	{
+		return *get();
+	}
+	T* operator->() const
+	{
+		return get();
+	}
+	explicit operator bool() const { return ptr_ != nullptr; }
+	bool operator!() const { return ptr_ == nullptr; }
+	//counts the owner's own reference along with soft pointers and pins
+	auto soft_count() const
+	{
+		return ptr_ ? ptr_->soft_count() : 0;
+	}
+	atomic_soft_ptr<T> soft() const
+	{
+		return atomic_soft_ptr<T>(*this);
+	}
+	void clear()
+	{
+		if (!ptr_) return;
+		ptr_->expire();
+		ptr_ = nullptr;
+	}
+	~atomic_exposed_ptr()
+	{
+		clear();
+	}
+};
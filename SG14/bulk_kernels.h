@@ -0,0 +1,155 @@
+#pragma once
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <type_traits>
+#include <stdint.h>
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
+
+//bulk copy, fill and compare over contiguous ranges, used by varray and span
+//trivially copyable types go to memcpy/memset or AVX2 loops, everything else to the std algorithms
+namespace stdext
+{
+	//types whose operator== is equivalent to comparing object bytes
+	//floating point is excluded because of -0.0 and NaN, specialize this for padding free aggregates
+	template<class T>
+	struct is_bitwise_comparable
+		: std::integral_constant<bool, std::is_integral<T>::value || std::is_enum<T>::value || std::is_pointer<T>::value>
+	{};
+
+	namespace detail_
+	{
+#if defined(__AVX2__)
+		inline bool equal_bytes(const unsigned char* a, const unsigned char* b, size_t n)
+		{
+			for (; n >= 32; n -= 32, a += 32, b += 32)
+			{
+				auto va = _mm256_loadu_si256((const __m256i*)a);
+				auto vb = _mm256_loadu_si256((const __m256i*)b);
+				if (_mm256_movemask_epi8(_mm256_cmpeq_epi8(va, vb)) != -1)
+				{
+					return false;
+				}
+			}
+			return memcmp(a, b, n) == 0;
+		}
+		inline void fill_pattern(unsigned char* dst, size_t n, __m256i pattern)
+		{
+			for (; n >= 32; n -= 32, dst += 32)
+			{
+				_mm256_storeu_si256((__m256i*)dst, pattern);
+			}
+			alignas(32) unsigned char tail[32];
+			_mm256_store_si256((__m256i*)tail, pattern);
+			memcpy(dst, tail, n);
+		}
+#else
+		inline bool equal_bytes(const unsigned char* a, const unsigned char* b, size_t n)
+		{
+			return memcmp(a, b, n) == 0;
+		}
+#endif
+
+		template<class T>
+		void fill_trivial(T* dst, int64_t n, const T& value, std::integral_constant<size_t, 1>)
+		{
+			unsigned char byte;
+			memcpy(&byte, &value, 1);
+			memset(dst, byte, n);
+		}
+#if defined(__AVX2__)
+		template<class T>
+		void fill_trivial(T* dst, int64_t n, const T& value, std::integral_constant<size_t, 2>)
+		{
+			int16_t bits;
+			memcpy(&bits, &value, 2);
+			fill_pattern((unsigned char*)dst, n * 2, _mm256_set1_epi16(bits));
+		}
+		template<class T>
+		void fill_trivial(T* dst, int64_t n, const T& value, std::integral_constant<size_t, 4>)
+		{
+			int32_t bits;
+			memcpy(&bits, &value, 4);
+			fill_pattern((unsigned char*)dst, n * 4, _mm256_set1_epi32(bits));
+		}
+		template<class T>
+		void fill_trivial(T* dst, int64_t n, const T& value, std::integral_constant<size_t, 8>)
+		{
+			int64_t bits;
+			memcpy(&bits, &value, 8);
+			fill_pattern((unsigned char*)dst, n * 8, _mm256_set1_epi64x(bits));
+		}
+#endif
+		template<class T, size_t Size>
+		void fill_trivial(T* dst, int64_t n, const T& value, std::integral_constant<size_t, Size>)
+		{
+			std::uninitialized_fill_n(dst, n, value);
+		}
+	}
+
+	namespace detail_
+	{
+		template<class T>
+		T* bulk_copy(const T* src, int64_t n, T* dst, std::true_type)
+		{
+			if (n > 0)
+			{
+				memcpy(dst, src, n * sizeof(T));
+			}
+			return dst + n;
+		}
+		template<class T>
+		T* bulk_copy(const T* src, int64_t n, T* dst, std::false_type)
+		{
+			return std::uninitialized_copy_n(src, n, dst);
+		}
+
+		template<class T>
+		T* bulk_fill(T* dst, int64_t n, const T& value, std::true_type)
+		{
+			if (n > 0)
+			{
+				fill_trivial(dst, n, value, std::integral_constant<size_t, sizeof(T)>());
+			}
+			return dst + n;
+		}
+		template<class T>
+		T* bulk_fill(T* dst, int64_t n, const T& value, std::false_type)
+		{
+			return std::uninitialized_fill_n(dst, n, value);
+		}
+
+		template<class T>
+		bool bulk_equal(const T* a, const T* b, int64_t n, std::true_type)
+		{
+			return a == b || n <= 0 || equal_bytes((const unsigned char*)a, (const unsigned char*)b, n * sizeof(T));
+		}
+		template<class T>
+		bool bulk_equal(const T* a, const T* b, int64_t n, std::false_type)
+		{
+			return std::equal(a, a + n, b);
+		}
+	}
+
+	//copy constructs n elements from src into the uninitialized range at dst
+	template<class T>
+	T* bulk_copy(const T* src, int64_t n, T* dst)
+	{
+		return detail_::bulk_copy(src, n, dst, std::is_trivially_copyable<T>());
+	}
+
+	//copy constructs n copies of value into the uninitialized range at dst
+	template<class T>
+	T* bulk_fill(T* dst, int64_t n, const T& value)
+	{
+		return detail_::bulk_fill(dst, n, value, std::is_trivially_copyable<T>());
+	}
+
+	template<class T>
+	bool bulk_equal(const T* a, const T* b, int64_t n)
+	{
+		return detail_::bulk_equal(a, b, n, is_bitwise_comparable<T>());
+	}
+}
@@ -0,0 +1,214 @@
+#pragma once
+#include "varray_allocators.h"
+
+//stack built from a linked chain of geometrically growing blocks, growing never moves elements
+//popping out of a block keeps it as a spare, so pushing and popping around a block boundary does not allocate
+//blocks are allocated through Allocator::typed
+// provides no exception guarantees
+template<typename T, typename Allocator = heap_allocator<grow_default<32>> >
+class chunked_stack
+{
+	static constexpr int64_t min_block_capacity = 8;
+	static constexpr int64_t max_block_capacity = 65536;
+
+	struct block
+	{
+		typename Allocator::template typed<T> storage_;
+		block* prev_ = nullptr;
+		block* next_ = nullptr;
+		int64_t capacity_ = 0;
+	};
+
+	block* current_ = nullptr;
+	T* block_begin_ = nullptr;
+	T* top_ = nullptr;
+	T* block_end_ = nullptr;
+	int64_t count_ = 0;
+	int64_t capacity_ = 0;
+public:
+	using ElementT = T;
+	chunked_stack() noexcept(true) = default;
+	chunked_stack(const chunked_stack& other)
+	{
+		other.for_each([&](const T& item) { push(item); });
+	}
+	chunked_stack(chunked_stack&& other) noexcept(true)
+		: current_(other.current_), block_begin_(other.block_begin_), top_(other.top_), block_end_(other.block_end_)
+		, count_(other.count_), capacity_(other.capacity_)
+	{
+		other.current_ = nullptr;
+		other.block_begin_ = other.top_ = other.block_end_ = nullptr;
+		other.count_ = other.capacity_ = 0;
+	}
+	chunked_stack& operator=(chunked_stack&& other) noexcept(true)
+	{
+		this->~chunked_stack();
+		new(this) chunked_stack(std::move(other));
+		return *this;
+	}
+	chunked_stack& operator=(const chunked_stack& other)
+	{
+		if (this != &other)
+		{
+			clear();
+			other.for_each([&](const T& item) { push(item); });
+		}
+		return *this;
+	}
+	~chunked_stack() noexcept(true)
+	{
+		clear();
+	}
+
+	T& push(const T& Item)
+	{
+		return emplace(Item);
+	}
+	T& push(T&& Item)
+	{
+		return emplace(std::move(Item));
+	}
+	template<class... Args>
+	T& emplace(Args&&... args)
+	{
+		if (top_ == block_end_)
+		{
+			next_block();
+		}
+		auto result = new(top_) T(std::forward<Args>(args)...);
+		++top_;
+		++count_;
+		return *result;
+	}
+	T pop()
+	{
+		assert(count_ > 0);
+		auto Result = std::move(top());
+		--top_;
+		stdext::destroy_at(top_);
+		--count_;
+		if (top_ == block_begin_ && current_->prev_)
+		{
+			previous_block();
+		}
+		return Result;
+	}
+	T& top()
+	{
+		assert(count_ > 0);
+		return *(top_ - 1);
+	}
+	const T& top() const
+	{
+		assert(count_ > 0);
+		return *(top_ - 1);
+	}
+
+	int64_t size() const noexcept(true)
+	{
+		return count_;
+	}
+	bool empty() const noexcept(true)
+	{
+		return count_ == 0;
+	}
+	//includes the spare block
+	int64_t capacity() const noexcept(true)
+	{
+		return capacity_;
+	}
+
+	//calls f for every element from the bottom of the stack to the top
+	template<class F>
+	void for_each(F&& f) const
+	{
+		if (!current_)
+		{
+			return;
+		}
+		auto b = current_;
+		while (b->prev_)
+		{
+			b = b->prev_;
+		}
+		for (; b != current_; b = b->next_)
+		{
+			auto data = b->storage_.data();
+			for (auto it = data, e = data + b->capacity_; it != e; ++it)
+			{
+				f(*it);
+			}
+		}
+		for (auto it = block_begin_; it != top_; ++it)
+		{
+			f(*it);
+		}
+	}
+	//releases the spare block
+	void shrink_to_fit()
+	{
+		if (current_ && current_->next_)
+		{
+			free_block(current_->next_);
+			current_->next_ = nullptr;
+		}
+	}
+	void clear()
+	{
+		if (!current_)
+		{
+			return;
+		}
+		shrink_to_fit();
+		stdext::destroy(block_begin_, top_);
+		for (auto b = current_->prev_; b; )
+		{
+			auto prev = b->prev_;
+			stdext::destroy_n(b->storage_.data(), b->capacity_);
+			free_block(b);
+			b = prev;
+		}
+		free_block(current_);
+		current_ = nullptr;
+		block_begin_ = top_ = block_end_ = nullptr;
+		count_ = 0;
+	}
+
+private:
+	void next_block()
+	{
+		if (current_ && current_->next_)
+		{
+			current_ = current_->next_;
+		}
+		else
+		{
+			auto b = new block();
+			b->capacity_ = std::min(std::max(count_, min_block_capacity), max_block_capacity);
+			b->storage_.realloc_exact(0, b->capacity_, 0);
+			b->prev_ = current_;
+			if (current_)
+			{
+				current_->next_ = b;
+			}
+			current_ = b;
+			capacity_ += b->capacity_;
+		}
+		block_begin_ = top_ = current_->storage_.data();
+		block_end_ = block_begin_ + current_->capacity_;
+	}
+	//the emptied block becomes the spare and any older spare is released
+	void previous_block()
+	{
+		shrink_to_fit();
+		current_ = current_->prev_;
+		block_begin_ = current_->storage_.data();
+		block_end_ = top_ = block_begin_ + current_->capacity_;
+	}
+	void free_block(block* b)
+	{
+		capacity_ -= b->capacity_;
+		b->storage_.free(0, b->capacity_);
+		delete b;
+	}
+};
@@ -0,0 +1,407 @@
+#pragma once
+#include <cstring>
+#include <iterator>
+#include "varray_allocators.h"
+
+//unordered container with O(1) insert and erase that never moves or invalidates surviving elements
+//elements live in a chain of geometrically growing groups, erased slots are reused by later inserts,
+//and iteration skips erased runs using a jump-counting skipfield
+//groups are allocated through Allocator::typed and released as soon as they become empty
+// provides no exception guarantees
+template<typename T, typename Allocator = heap_allocator<grow_default<32>> >
+class colony
+{
+	using index_t = uint16_t;
+	static constexpr index_t no_slot = 0xffff;
+	static constexpr index_t min_group_capacity = 8;
+	static constexpr index_t max_group_capacity = 8192;
+
+	//an erased slot that starts a skip block holds the links of its group's free list
+	struct free_links
+	{
+		index_t prev_;
+		index_t next_;
+	};
+	using slot = typename std::aligned_storage<(sizeof(T) > sizeof(free_links) ? sizeof(T) : sizeof(free_links)),
+		(alignof(T) > alignof(free_links) ? alignof(T) : alignof(free_links))>::type;
+
+	//skipfield_[i] is 0 for a live element, erased runs store their length in their first and last entries
+	//one extra zero entry past the capacity ends every jump
+	struct group
+	{
+		typename Allocator::template typed<slot> elements_;
+		typename Allocator::template typed<index_t> skipfield_;
+		group* next_ = nullptr;
+		group* prev_ = nullptr;
+		group* next_free_ = nullptr;
+		group* prev_free_ = nullptr;
+		index_t capacity_ = 0;
+		index_t size_ = 0;
+		//slots at or past this have never been used
+		index_t high_water_ = 0;
+		//first slot of a skip block available for reuse
+		index_t free_head_ = no_slot;
+
+		T* element(index_t i) const
+		{
+			return (T*)(elements_.data() + i);
+		}
+		index_t* skipfield() const
+		{
+			return skipfield_.data();
+		}
+		free_links& links(index_t i) const
+		{
+			return *(free_links*)(elements_.data() + i);
+		}
+	};
+
+	group* first_ = nullptr;
+	group* last_ = nullptr;
+	//groups with a nonempty free list
+	group* free_groups_ = nullptr;
+	int64_t size_ = 0;
+	int64_t capacity_ = 0;
+
+	template<class U>
+	class basic_iterator
+	{
+		friend class colony;
+		group* group_ = nullptr;
+		index_t index_ = 0;
+		basic_iterator(group* g, index_t i)
+			: group_(g), index_(i)
+		{}
+	public:
+		using iterator_category = std::forward_iterator_tag;
+		using value_type = T;
+		using difference_type = std::ptrdiff_t;
+		using pointer = U*;
+		using reference = U&;
+
+		basic_iterator() = default;
+		template<class V, class = std::enable_if_t<std::is_const<U>::value && !std::is_const<V>::value>>
+		basic_iterator(const basic_iterator<V>& other)
+			: group_(other.group_), index_(other.index_)
+		{}
+		U& operator*() const
+		{
+			return *group_->element(index_);
+		}
+		U* operator->() const
+		{
+			return group_->element(index_);
+		}
+		basic_iterator& operator++()
+		{
+			++index_;
+			index_ += group_->skipfield()[index_];
+			if (index_ >= group_->high_water_)
+			{
+				group_ = group_->next_;
+				index_ = group_ ? group_->skipfield()[0] : 0;
+			}
+			return *this;
+		}
+		basic_iterator operator++(int)
+		{
+			auto result = *this;
+			++*this;
+			return result;
+		}
+		friend bool operator==(const basic_iterator& a, const basic_iterator& b)
+		{
+			return a.group_ == b.group_ && a.index_ == b.index_;
+		}
+		friend bool operator!=(const basic_iterator& a, const basic_iterator& b)
+		{
+			return !(a == b);
+		}
+		template<class V> friend class basic_iterator;
+	};
+public:
+	using ElementT = T;
+	using iterator = basic_iterator<T>;
+	using const_iterator = basic_iterator<const T>;
+
+	colony() noexcept(true) = default;
+	colony(const colony& other)
+	{
+		for (auto& item : other)
+		{
+			insert(item);
+		}
+	}
+	colony(colony&& other) noexcept(true)
+		: first_(other.first_), last_(other.last_), free_groups_(other.free_groups_), size_(other.size_), capacity_(other.capacity_)
+	{
+		other.first_ = other.last_ = other.free_groups_ = nullptr;
+		other.size_ = other.capacity_ = 0;
+	}
+	colony& operator=(colony&& other) noexcept(true)
+	{
+		this->~colony();
+		new(this) colony(std::move(other));
+		return *this;
+	}
+	colony& operator=(const colony& other)
+	{
+		if (this != &other)
+		{
+			clear();
+			for (auto& item : other)
+			{
+				insert(item);
+			}
+		}
+		return *this;
+	}
+	~colony() noexcept(true)
+	{
+		clear();
+	}
+
+	iterator insert(const T& item)
+	{
+		return emplace(item);
+	}
+	iterator insert(T&& item)
+	{
+		return emplace(std::move(item));
+	}
+	template<class... Args>
+	iterator emplace(Args&&... args)
+	{
+		group* g;
+		index_t i;
+		if (free_groups_)
+		{
+			g = free_groups_;
+			i = reuse_slot(g);
+		}
+		else
+		{
+			if (!last_ || last_->high_water_ == last_->capacity_)
+			{
+				add_group();
+			}
+			g = last_;
+			i = g->high_water_++;
+		}
+		new(g->element(i)) T(std::forward<Args>(args)...);
+		++g->size_;
+		++size_;
+		return iterator(g, i);
+	}
+
+	//returns the element after the erased one, other iterators and pointers stay valid
+	iterator erase(const_iterator pos)
+	{
+		auto g = pos.group_;
+		auto i = pos.index_;
+		iterator next(g, i);
+		++next;
+
+		stdext::destroy_at(g->element(i));
+		--size_;
+		if (--g->size_ == 0)
+		{
+			remove_group(g);
+			return next;
+		}
+
+		auto skip = g->skipfield();
+		index_t left = i > 0 ? skip[i - 1] : 0;
+		index_t right = skip[i + 1];
+		if (!left && !right)
+		{
+			skip[i] = 1;
+			push_free_block(g, i);
+		}
+		else if (!right)
+		{
+			//extends the block ending at i - 1
+			auto length = index_t(left + 1);
+			skip[i - left] = length;
+			skip[i] = length;
+		}
+		else if (!left)
+		{
+			//becomes the new start of the block starting at i + 1
+			auto length = index_t(right + 1);
+			skip[i] = length;
+			skip[i + right] = length;
+			replace_free_block(g, i + 1, i);
+		}
+		else
+		{
+			//joins the blocks on either side
+			auto length = index_t(left + right + 1);
+			skip[i - left] = length;
+			skip[i + right] = length;
+			remove_free_block(g, i + 1);
+		}
+		return next;
+	}
+
+	iterator begin() noexcept(true)
+	{
+		return iterator(first_, first_ ? first_->skipfield()[0] : 0);
+	}
+	iterator end() noexcept(true)
+	{
+		return iterator();
+	}
+	const_iterator begin() const noexcept(true)
+	{
+		return const_iterator(first_, first_ ? first_->skipfield()[0] : 0);
+	}
+	const_iterator end() const noexcept(true)
+	{
+		return const_iterator();
+	}
+
+	int64_t size() const noexcept(true)
+	{
+		return size_;
+	}
+	bool empty() const noexcept(true)
+	{
+		return size_ == 0;
+	}
+	int64_t capacity() const noexcept(true)
+	{
+		return capacity_;
+	}
+	void clear()
+	{
+		for (auto it = begin(); it != end(); ++it)
+		{
+			stdext::destroy_at(&*it);
+		}
+		while (first_)
+		{
+			auto next = first_->next_;
+			free_group(first_);
+			first_ = next;
+		}
+		last_ = free_groups_ = nullptr;
+		size_ = capacity_ = 0;
+	}
+
+private:
+	void add_group()
+	{
+		auto capacity = index_t(std::min<int64_t>(std::max<int64_t>(size_, min_group_capacity), max_group_capacity));
+		auto g = new group();
+		g->elements_.realloc_exact(0, capacity, 0);
+		g->skipfield_.realloc_exact(0, capacity + 1, 0);
+		memset(g->skipfield(), 0, (capacity + 1) * sizeof(index_t));
+		g->capacity_ = capacity;
+		g->prev_ = last_;
+		if (last_)
+		{
+			last_->next_ = g;
+		}
+		else
+		{
+			first_ = g;
+		}
+		last_ = g;
+		capacity_ += capacity;
+	}
+	void free_group(group* g)
+	{
+		capacity_ -= g->capacity_;
+		g->elements_.free(0, g->capacity_);
+		g->skipfield_.free(0, g->capacity_ + 1);
+		delete g;
+	}
+	void remove_group(group* g)
+	{
+		if (g->free_head_ != no_slot)
+		{
+			unlink_free_group(g);
+		}
+		(g->prev_ ? g->prev_->next_ : first_) = g->next_;
+		(g->next_ ? g->next_->prev_ : last_) = g->prev_;
+		free_group(g);
+	}
+
+	//takes the first slot of g's first skip block
+	index_t reuse_slot(group* g)
+	{
+		auto skip = g->skipfield();
+		auto i = g->free_head_;
+		auto length = skip[i];
+		if (length == 1)
+		{
+			remove_free_block(g, i);
+		}
+		else
+		{
+			auto shorter = index_t(length - 1);
+			skip[i + 1] = shorter;
+			skip[i + length - 1] = shorter;
+			replace_free_block(g, i, i + 1);
+		}
+		skip[i] = 0;
+		return i;
+	}
+
+	void push_free_block(group* g, index_t i)
+	{
+		if (g->free_head_ == no_slot)
+		{
+			link_free_group(g);
+		}
+		else
+		{
+			g->links(g->free_head_).prev_ = i;
+		}
+		g->links(i) = free_links{ no_slot, g->free_head_ };
+		g->free_head_ = i;
+	}
+	void remove_free_block(group* g, index_t i)
+	{
+		auto links = g->links(i);
+		(links.prev_ != no_slot ? g->links(links.prev_).next_ : g->free_head_) = links.next_;
+		if (links.next_ != no_slot)
+		{
+			g->links(links.next_).prev_ = links.prev_;
+		}
+		if (g->free_head_ == no_slot)
+		{
+			unlink_free_group(g);
+		}
+	}
+	void replace_free_block(group* g, index_t from, index_t to)
+	{
+		auto links = g->links(from);
+		g->links(to) = links;
+		(links.prev_ != no_slot ? g->links(links.prev_).next_ : g->free_head_) = to;
+		if (links.next_ != no_slot)
+		{
+			g->links(links.next_).prev_ = to;
+		}
+	}
+
+	void link_free_group(group* g)
+	{
+		g->prev_free_ = nullptr;
+		g->next_free_ = free_groups_;
+		if (free_groups_)
+		{
+			free_groups_->prev_free_ = g;
+		}
+		free_groups_ = g;
+	}
+	void unlink_free_group(group* g)
+	{
+		(g->prev_free_ ? g->prev_free_->next_free_ : free_groups_) = g->next_free_;
+		if (g->next_free_)
+		{
+			g->next_free_->prev_free_ = g->prev_free_;
+		}
+	}
+};
@@ -0,0 +1,244 @@
+#pragma once
+#include <stdint.h>
+#include <atomic>
+#include <type_traits>
+#if defined(_M_X64) || defined(_M_IX86) || defined(__x86_64__) || defined(__i386__)
+#define SG14_COMPACT_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER)
+#include <intrin.h>
+#define SG14_TARGET(features)
+#else
+#define SG14_TARGET(features) __attribute__((target(features)))
+#endif
+#endif
+
+//branchless and SIMD compaction behind stdext::remove_if and stdext::unstable_remove_if for contiguous ranges of
+//arithmetic, enum and pointer types, where mispredicted branches cost more than the moves they skip
+//the predicate is still called once per element in order, only the data movement is vectorized
+//only remove_if is vectorized, the SIMD kernels rewrite every kept element, while unstable_remove_if keeps its
+//contract of moving only into removed slots and gets the branchless scalar kernel
+//the kernel is picked at runtime from the CPU features, so one binary runs everywhere
+namespace stdext
+{
+	template<class T>
+	struct is_compactable
+		: std::integral_constant<bool, std::is_arithmetic<T>::value || std::is_enum<T>::value || std::is_pointer<T>::value>
+	{};
+
+	enum class simd_level
+	{
+		scalar,
+		avx2,
+		avx512,
+	};
+
+	namespace detail_
+	{
+		inline simd_level detect_simd_level()
+		{
+#if defined(SG14_COMPACT_X86)
+#if defined(_MSC_VER)
+			int regs[4];
+			__cpuid(regs, 0);
+			if (regs[0] < 7)
+			{
+				return simd_level::scalar;
+			}
+			__cpuid(regs, 1);
+			if (!(regs[2] & (1 << 27)))
+			{
+				return simd_level::scalar;
+			}
+			auto xcr0 = _xgetbv(0);
+			__cpuidex(regs, 7, 0);
+			if ((regs[1] & (1 << 16)) && (xcr0 & 0xe6) == 0xe6)
+			{
+				return simd_level::avx512;
+			}
+			if ((regs[1] & (1 << 5)) && (xcr0 & 0x6) == 0x6)
+			{
+				return simd_level::avx2;
+			}
+#else
+			__builtin_cpu_init();
+			if (__builtin_cpu_supports("avx512f"))
+			{
+				return simd_level::avx512;
+			}
+			if (__builtin_cpu_supports("avx2"))
+			{
+				return simd_level::avx2;
+			}
+#endif
+#endif
+			return simd_level::scalar;
+		}
+	}
+
+	//the widest kernel the compaction algorithms use, detected from the CPU on first use
+	//lower it to test or benchmark the narrower kernels, calls already running keep the kernel they picked
+	inline std::atomic<simd_level>& compact_simd_level()
+	{
+		static std::atomic<simd_level> level(detail_::detect_simd_level());
+		return level;
+	}
+
+	namespace detail_
+	{
+		//stores every element and advances the output past the kept ones
+		template<class T, class Pred>
+		T* compact_scalar(T* first, T* last, T* out, Pred& p)
+		{
+			for (; first != last; ++first)
+			{
+				T value = *first;
+				*out = value;
+				out += !p(*first);
+			}
+			return out;
+		}
+		//unstable_remove_if with selects in place of branches, a removed element is overwritten by the last one,
+		//which is tested on the next step, so each element is still tested once and moved at most once
+		template<class T, class Pred>
+		T* unstable_compact_scalar(T* first, T* last, Pred& p)
+		{
+			while (first != last)
+			{
+				bool remove = p(*first);
+				T back = last[-1];
+				*first = remove ? back : *first;
+				last -= remove;
+				first += !remove;
+			}
+			return first;
+		}
+
+		//bit i set when lane i is kept
+		template<int Lanes, class T, class Pred>
+		uint32_t keep_mask(T* src, Pred& p)
+		{
+			uint32_t keep = 0;
+			for (int i = 0; i < Lanes; ++i)
+			{
+				keep |= uint32_t(!p(src[i])) << i;
+			}
+			return keep;
+		}
+
+#if defined(SG14_COMPACT_X86)
+		//32 bit lane indices that pack the kept lanes of a 256 bit vector of Lanes elements to the front
+		template<int Lanes>
+		struct compress_lut
+		{
+			uint8_t index_[1 << Lanes][8];
+			constexpr compress_lut()
+				: index_()
+			{
+				constexpr int width = 8 / Lanes;
+				for (int mask = 0; mask < (1 << Lanes); ++mask)
+				{
+					int out = 0;
+					for (int lane = 0; lane < Lanes; ++lane)
+					{
+						if (mask & (1 << lane))
+						{
+							for (int part = 0; part < width; ++part)
+							{
+								index_[mask][out++] = uint8_t(lane * width + part);
+							}
+						}
+					}
+				}
+			}
+		};
+		template<int Lanes>
+		const compress_lut<Lanes>& compress_table()
+		{
+			static constexpr compress_lut<Lanes> table{};
+			return table;
+		}
+
+		//each block stores a full vector at the output, which never passes the unread input
+		template<class T, class Pred>
+		SG14_TARGET("avx2,popcnt")
+		T* compact_avx2(T* first, T* last, Pred& p)
+		{
+			constexpr int lanes = 32 / sizeof(T);
+			const auto& table = compress_table<lanes>();
+			auto out = first;
+			for (; last - first >= lanes; first += lanes)
+			{
+				auto keep = keep_mask<lanes>(first, p);
+				auto values = _mm256_loadu_si256((const __m256i*)first);
+				auto index = _mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)table.index_[keep]));
+				_mm256_storeu_si256((__m256i*)out, _mm256_permutevar8x32_epi32(values, index));
+				out += _mm_popcnt_u32(keep);
+			}
+			return compact_scalar(first, last, out, p);
+		}
+
+		template<class T, class Pred>
+		SG14_TARGET("avx512f,popcnt")
+		T* compact_avx512(T* first, T* last, Pred& p)
+		{
+			constexpr int lanes = 64 / sizeof(T);
+			auto out = first;
+			for (; last - first >= lanes; first += lanes)
+			{
+				auto keep = keep_mask<lanes>(first, p);
+				auto values = _mm512_loadu_si512((const void*)first);
+				if (sizeof(T) == 4)
+				{
+					_mm512_mask_compressstoreu_epi32((void*)out, __mmask16(keep), values);
+				}
+				else
+				{
+					_mm512_mask_compressstoreu_epi64((void*)out, __mmask8(keep), values);
+				}
+				out += _mm_popcnt_u32(keep);
+			}
+			return compact_scalar(first, last, out, p);
+		}
+#endif
+
+		template<class T, class Pred>
+		T* compact_simd(T* first, T* last, Pred& p, std::true_type)
+		{
+#if defined(SG14_COMPACT_X86)
+			if (compact_simd_level().load(std::memory_order_relaxed) == simd_level::avx512)
+			{
+				return compact_avx512(first, last, p);
+			}
+			return compact_avx2(first, last, p);
+#else
+			return compact_scalar(first, last, first, p);
+#endif
+		}
+		template<class T, class Pred>
+		T* compact_simd(T* first, T* last, Pred& p, std::false_type)
+		{
+			return compact_scalar(first, last, first, p);
+		}
+		template<class T>
+		bool use_simd_compaction()
+		{
+			return (sizeof(T) == 4 || sizeof(T) == 8) && compact_simd_level().load(std::memory_order_relaxed) != simd_level::scalar;
+		}
+
+		template<class T, class Pred>
+		T* remove_if_compact(T* first, T* last, Pred& p)
+		{
+			if (use_simd_compaction<T>())
+			{
+				return compact_simd(first, last, p, std::integral_constant<bool, sizeof(T) == 4 || sizeof(T) == 8>());
+			}
+			return compact_scalar(first, last, first, p);
+		}
+		template<class T, class Pred>
+		T* unstable_remove_if_compact(T* first, T* last, Pred& p)
+		{
+			return unstable_compact_scalar(first, last, p);
+		}
+	}
+}
@@ -0,0 +1,175 @@
+#pragma once
+#include <atomic>
+#include "varray.h"
+
+//copy on write varray: copies share one refcounted buffer, and the first mutation through a shared copy detaches it
+//shared buffers are never written, so a snapshot handed to another thread stays consistent while the owner keeps editing
+//the refcount is atomic, a single cow_varray object is still not safe to use from several threads at once
+template<typename T, typename Allocator = heap_allocator<grow_default<32>> >
+class cow_varray
+{
+	struct block
+	{
+		std::atomic<int64_t> refs_;
+		varray<T, Allocator> items_;
+	};
+	block* block_ = nullptr;
+
+	static block* make_block(varray<T, Allocator>&& items)
+	{
+		auto result = new block();
+		result->refs_.store(1, std::memory_order_relaxed);
+		result->items_ = std::move(items);
+		return result;
+	}
+public:
+	using ElementT = T;
+	cow_varray() noexcept(true) = default;
+	cow_varray(std::initializer_list<T> items)
+		: block_(make_block(varray<T, Allocator>(items)))
+	{}
+	//takes ownership of items without copying them
+	explicit cow_varray(varray<T, Allocator>&& items)
+		: block_(make_block(std::move(items)))
+	{}
+	//O(1), shares the buffer
+	cow_varray(const cow_varray& other) noexcept(true)
+		: block_(other.block_)
+	{
+		if (block_) block_->refs_.fetch_add(1, std::memory_order_relaxed);
+	}
+	cow_varray(cow_varray&& other) noexcept(true)
+		: block_(other.block_)
+	{
+		other.block_ = nullptr;
+	}
+	cow_varray& operator=(const cow_varray& other) noexcept(true)
+	{
+		if (block_ != other.block_)
+		{
+			release();
+			block_ = other.block_;
+			if (block_) block_->refs_.fetch_add(1, std::memory_order_relaxed);
+		}
+		return *this;
+	}
+	cow_varray& operator=(cow_varray&& other) noexcept(true)
+	{
+		if (this != &other)
+		{
+			release();
+			block_ = other.block_;
+			other.block_ = nullptr;
+		}
+		return *this;
+	}
+	~cow_varray() noexcept(true)
+	{
+		release();
+	}
+
+	const T* begin() const noexcept(true)
+	{
+		return block_ ? block_->items_.begin() : nullptr;
+	}
+	const T* end() const noexcept(true)
+	{
+		return block_ ? block_->items_.end() : nullptr;
+	}
+	int64_t size() const noexcept(true)
+	{
+		return block_ ? block_->items_.size() : 0;
+	}
+	const T& operator[](int64_t i) const
+	{
+		assert(i >= 0 && (i<size()));
+		return begin()[i];
+	}
+	const T& front() const
+	{
+		return *(begin());
+	}
+	const T& back() const
+	{
+		return *(end() - 1);
+	}
+	span<const T> view() const
+	{
+		return span<const T>(begin(), end());
+	}
+	operator span<const T>() const
+	{
+		return view();
+	}
+	bool operator==(span<const T> OtherArray) const
+	{
+		return size() == int64_t(OtherArray.size()) && stdext::bulk_equal(begin(), OtherArray.begin(), size());
+	}
+	bool operator!=(span<const T> OtherArray) const
+	{
+		return !(*this == OtherArray);
+	}
+
+	int64_t use_count() const noexcept(true)
+	{
+		return block_ ? block_->refs_.load(std::memory_order_relaxed) : 0;
+	}
+	//true when edit() can mutate in place, the acquire pairs with the release in other copies' release()
+	bool unique() const noexcept(true)
+	{
+		return !block_ || block_->refs_.load(std::memory_order_acquire) == 1;
+	}
+
+	//detaches from any shared buffer and returns the array for mutation
+	//the reference is invalidated by copying this cow_varray and then editing either copy
+	varray<T, Allocator>& edit()
+	{
+		if (!block_)
+		{
+			block_ = make_block(varray<T, Allocator>());
+		}
+		else if (!unique())
+		{
+			auto detached = make_block(varray<T, Allocator>(block_->items_));
+			release();
+			block_ = detached;
+		}
+		return block_->items_;
+	}
+
+	T& push_back(const T& Item)
+	{
+		return edit().push_back(Item);
+	}
+	T& push_back(T&& Item)
+	{
+		return edit().push_back(std::move(Item));
+	}
+	template<class... Args >
+	T& emplace_back(Args&&... args)
+	{
+		return edit().emplace_back(std::forward<Args>(args)...);
+	}
+	//dropping a shared buffer needs no copy
+	void clear()
+	{
+		if (unique())
+		{
+			if (block_) block_->items_.clear();
+		}
+		else
+		{
+			release();
+		}
+	}
+
+private:
+	void release() noexcept(true)
+	{
+		if (block_ && block_->refs_.fetch_sub(1, std::memory_order_acq_rel) == 1)
+		{
+			delete block_;
+		}
+		block_ = nullptr;
+	}
+};
@@ -0,0 +1,106 @@
+#pragma once
+#include "exposed_ptr.h"
+
+//source of exposed_ptrs whose control blocks sit side by side in chunks of ChunkSlots
+//handles are ordinary exposed_ptr and soft_ptr, for_each_live walks the chunks in address order
+//chunks are aligned to their size, so a block finds its pool from its own address when the last reference lets go
+//the pool must outlive every exposed_ptr and soft_ptr it handed out
+// provides no exception guarantees
+template<class T, int64_t ChunkSlots = 64>
+class exposed_pool
+{
+	using ctrl = detail_::softctrl<T>;
+	struct chunk
+	{
+		exposed_pool* pool_;
+	};
+	static constexpr size_t slots_offset = (sizeof(chunk) + alignof(ctrl) - 1) / alignof(ctrl) * alignof(ctrl);
+	static constexpr size_t chunk_bytes()
+	{
+		size_t bytes = 64;
+		while (bytes < slots_offset + ChunkSlots * sizeof(ctrl))
+		{
+			bytes *= 2;
+		}
+		return bytes;
+	}
+	static_assert(ChunkSlots > 0, "chunks need at least one slot");
+
+	varray<chunk*> chunks_;
+	//unused blocks, popped from the back so a new chunk is handed out in address order
+	varray<ctrl*> free_;
+
+	static ctrl* slots(chunk* c) noexcept(true)
+	{
+		return (ctrl*)((std::byte*)c + slots_offset);
+	}
+	void add_chunk()
+	{
+		auto c = new(::operator new(chunk_bytes(), std::align_val_t(chunk_bytes()))) chunk{ this };
+		chunks_.push_back(c);
+		auto s = slots(c);
+		for (auto i = ChunkSlots; i-- > 0;)
+		{
+			//never constructed slots read as invalid to for_each_live
+			free_.push_back(new(s + i) ctrl());
+		}
+	}
+	static void release_slot(void* p) noexcept(true)
+	{
+		auto c = (chunk*)(uintptr_t(p) & ~uintptr_t(chunk_bytes() - 1));
+		c->pool_->free_.push_back((ctrl*)p);
+	}
+
+public:
+	exposed_pool() = default;
+	exposed_pool(const exposed_pool&) = delete;
+	exposed_pool& operator=(const exposed_pool&) = delete;
+
+	template<class Destroy = destroy_now, class... Args>
+	exposed_ptr<T, Destroy> make(Args&&... args)
+	{
+		if (free_.size() == 0)
+		{
+			add_chunk();
+		}
+		auto block = free_.pop_back();
+		block->release_ = &release_slot;
+		return exposed_ptr<T, Destroy>::construct(block, std::forward<Args>(args)...);
+	}
+
+	//calls f on every object whose owner is still alive
+	template<class F>
+	void for_each_live(F f)
+	{
+		for (auto c : chunks_)
+		{
+			auto s = slots(c);
+			for (int64_t i = 0; i < ChunkSlots; ++i)
+			{
+				if (s[i].valid_)
+				{
+					f(*(T*)&s[i].value_);
+				}
+			}
+		}
+	}
+
+	//blocks held by a live object or a soft_ptr
+	int64_t blocks_in_use() const noexcept(true)
+	{
+		return capacity() - free_.size();
+	}
+	int64_t capacity() const noexcept(true)
+	{
+		return chunks_.size() * ChunkSlots;
+	}
+
+	~exposed_pool()
+	{
+		assert(blocks_in_use() == 0);
+		for (auto c : chunks_)
+		{
+			::operator delete(c, std::align_val_t(chunk_bytes()));
+		}
+	}
+};
@@ -3,27 +3,152 @@
 #include <type_traits>
 #include <stdint.h>
 #include <cstddef>
+#include <new>
+#include <memory>
+#include <atomic>
+#include <mutex>
+#include "varray.h"
 
 namespace detail_
 {
 	template<class T>	struct softctrl;
 }
 template<class T> class soft_ptr;
+class enable_intrusive_soft_from_this;
+namespace detail_
+{
+	struct slot_backlink;
+}
+//intrusive types get their soft references from intrusive_soft_ptr.h, slot_map elements from slot_map.h instead
+template<class T>
+using soft_from_result = std::enable_if_t<!std::is_base_of<enable_intrusive_soft_from_this, T>::value && !std::is_base_of<detail_::slot_backlink, T>::value, soft_ptr<T>>;
 
 class enable_soft_from_this
 {
-	template<class T> friend soft_ptr<T> soft_from(T*);
+	template<class T> friend soft_from_result<T> soft_from(T*);
 	template<class T> friend struct detail_::softctrl;
 	bool made_exposed_ = false;
 };
 
 namespace detail_
 {
+	//per thread cache of fixed size blocks, refilled a slab at a time so neighbouring objects share cache lines
+	//a thread caching more than two slabs' worth hands one slab's worth back to a shared list, and hands back
+	//everything when it exits, so blocks freed on another thread, as in producer/consumer use, get reused
+	//slabs are never returned to the system, they stay reachable from the shared list
+	template<size_t Size, size_t Align>
+	class block_pool
+	{
+		struct free_block { free_block* next_; };
+		struct slab { slab* next_; };
+		static constexpr size_t stride_ = (Size + Align - 1) / Align * Align;
+		static constexpr size_t header_ = (sizeof(slab) + Align - 1) / Align * Align;
+		static constexpr size_t blocks_per_slab_ = stride_ < 4096 ? 4096 / stride_ : 1;
+		static_assert(Size >= sizeof(free_block), "block too small to link");
+
+		struct shared_list
+		{
+			std::mutex mutex_;
+			free_block* free_ = nullptr;
+			slab* slabs_ = nullptr;
+		};
+
+		free_block* free_ = nullptr;
+		size_t count_ = 0;
+		bool exited_ = false;
+
+		//never destroyed, so threads exiting after static destruction can still hand blocks back
+		static shared_list& shared() noexcept(true)
+		{
+			static shared_list* list = new shared_list();
+			return *list;
+		}
+		void push(free_block* b) noexcept(true)
+		{
+			b->next_ = free_;
+			free_ = b;
+			++count_;
+		}
+		free_block* pop() noexcept(true)
+		{
+			auto b = free_;
+			free_ = b->next_;
+			--count_;
+			return b;
+		}
+		void refill()
+		{
+			auto& list = shared();
+			std::lock_guard<std::mutex> lock(list.mutex_);
+			for (size_t i = 0; i < blocks_per_slab_ && list.free_; ++i)
+			{
+				auto b = list.free_;
+				list.free_ = b->next_;
+				push(b);
+			}
+			if (free_)
+			{
+				return;
+			}
+			auto mem = (std::byte*)::operator new(header_ + stride_ * blocks_per_slab_, std::align_val_t(Align));
+			list.slabs_ = new(mem) slab{ list.slabs_ };
+			//link back to front so blocks are handed out in address order
+			for (auto i = blocks_per_slab_; i-- > 0;)
+			{
+				push(new(mem + header_ + i * stride_) free_block);
+			}
+		}
+		void give_back(size_t n) noexcept(true)
+		{
+			auto& list = shared();
+			std::lock_guard<std::mutex> lock(list.mutex_);
+			for (; n > 0 && free_; --n)
+			{
+				auto b = pop();
+				b->next_ = list.free_;
+				list.free_ = b;
+			}
+		}
+	public:
+		static block_pool& local() noexcept(true)
+		{
+			thread_local block_pool pool;
+			return pool;
+		}
+		void* allocate()
+		{
+			if (!free_)
+			{
+				refill();
+			}
+			return pop();
+		}
+		void release(void* p) noexcept(true)
+		{
+			push(new(p) free_block);
+			if (exited_)
+			{
+				give_back(count_);
+			}
+			else if (count_ > 2 * blocks_per_slab_)
+			{
+				give_back(blocks_per_slab_);
+			}
+		}
+		~block_pool()
+		{
+			exited_ = true;
+			give_back(count_);
+		}
+	};
+
 	template<class T>
 	struct softctrl
 	{
 		uint32_t soft_count_ : 31;
 		bool valid_ : 1;
+		//frees the block once the object is dead and unreferenced, set by whoever allocated it
+		void(*release_)(void*) noexcept(true);
 		std::aligned_union_t<0, T> value_;
 		template<class U>
 		void mark_exposed(std::enable_if_t<!std::is_base_of<enable_soft_from_this, U>::value, void*> = nullptr) {}
@@ -35,19 +160,142 @@ namespace detail_
 			obj->made_exposed_ = true;
 		}
 	};
+
+	template<class T>
+	using softctrl_pool = block_pool<sizeof(softctrl<T>), alignof(softctrl<T>)>;
+
+	//control block allocated through a user allocator, which it carries so the last reference can free it
+	template<class T, class Alloc>
+	struct softctrl_alloc : softctrl<T>
+	{
+		using self_alloc = typename std::allocator_traits<Alloc>::template rebind_alloc<softctrl_alloc>;
+		self_alloc alloc_;
+
+		softctrl_alloc(const Alloc& alloc)
+			:alloc_(alloc)
+		{}
+		static void release(void* ctrl) noexcept(true)
+		{
+			auto self = static_cast<softctrl_alloc*>((softctrl<T>*)ctrl);
+			self_alloc alloc(std::move(self->alloc_));
+			self->~softctrl_alloc();
+			std::allocator_traits<self_alloc>::deallocate(alloc, self, 1);
+		}
+	};
 }
-template<class T> class exposed_ptr;
+//destruction policies for exposed_ptr, dispose runs once the owner lets go and the block is marked invalid
+
+//runs ~T inline and frees the block if no soft_ptr refers to it
+struct destroy_now
+{
+	template<class T>
+	static void dispose(detail_::softctrl<T>* ctrl) noexcept(true)
+	{
+		((T*)&ctrl->value_)->~T();
+		if (ctrl->soft_count_ == 0)
+		{
+			ctrl->release_(ctrl);
+		}
+	}
+};
+
+//queues ~T and the block release on this thread's retire list until drain() is called, e.g. at the end of a frame
+//the list holds a soft reference, so soft_ptrs see the object as gone at once while its storage stays put
+//anything left is drained when the thread exits
+//if the list cannot grow the object is destroyed at once instead, reserve() avoids growing on the latency path
+struct destroy_deferred
+{
+	template<class T>
+	static void dispose(detail_::softctrl<T>* ctrl) noexcept(true)
+	{
+		ctrl->soft_count_++;
+		try
+		{
+			retire_list::local().items_.push_back({ ctrl, &destroy<T> });
+		}
+		catch (...)
+		{
+			ctrl->soft_count_--;
+			destroy_now::dispose(ctrl);
+		}
+	}
+	//makes room for n pending destructions on this thread, e.g. a frame's worth
+	static void reserve(int64_t n)
+	{
+		auto& list = retire_list::local();
+		list.items_.grow_capacity_exact(n);
+		list.draining_.grow_capacity_exact(n);
+	}
+	//runs every queued destruction, including ones queued by the destructors it runs, returns how many ran
+	static int64_t drain() noexcept(true)
+	{
+		return retire_list::local().drain();
+	}
+	static int64_t pending() noexcept(true)
+	{
+		return retire_list::local().items_.size();
+	}
+private:
+	struct retired
+	{
+		void* ctrl_;
+		void(*destroy_)(void*) noexcept(true);
+	};
+	struct retire_list
+	{
+		varray<retired> items_;
+		varray<retired> draining_;
+
+		static retire_list& local() noexcept(true)
+		{
+			thread_local retire_list list;
+			return list;
+		}
+		int64_t drain() noexcept(true)
+		{
+			int64_t ran = 0;
+			while (items_.size() > 0)
+			{
+				std::swap(items_, draining_);
+				for (auto& r : draining_)
+				{
+					r.destroy_(r.ctrl_);
+				}
+				ran += draining_.size();
+				draining_.clear();
+			}
+			return ran;
+		}
+		~retire_list()
+		{
+			drain();
+		}
+	};
+	template<class T>
+	static void destroy(void* p) noexcept(true)
+	{
+		auto ctrl = (detail_::softctrl<T>*)p;
+		((T*)&ctrl->value_)->~T();
+		if (--ctrl->soft_count_ == 0)
+		{
+			ctrl->release_(ctrl);
+		}
+	}
+};
+
+template<class T, class Destroy = destroy_now> class exposed_ptr;
+template<class T, int64_t ChunkSlots> class exposed_pool;
 
 //soft_ptr: single threaded weak_ptr that works with exposed_ptr
 template<class T>
 class soft_ptr
 {
 	detail_::softctrl<T>* ptr_ = nullptr;
-	template<class T> friend class exposed_ptr;
+	template<class U, class D> friend class exposed_ptr;
 	template<class T> friend class soft_ptr;
 public:
-	template<class U>
-	soft_ptr(const exposed_ptr<U>& a)
+	template<class U, class D>
+	soft_ptr(const exposed_ptr<U, D>& a)
 	{
 		static_assert(std::is_same<T,U>::value || std::is_base_of_v<T, U>, "Invalid cast");
 		ptr_ = reinterpret_cast<decltype(ptr_)>(a.ptr_);
@@ -120,7 +368,7 @@ public:
 
 		if (!ptr_->valid_ && ptr_->soft_count_ == 1)
 		{
-			delete ptr_;
+			ptr_->release_(ptr_);
 		}
 		else
 		{
@@ -153,7 +401,7 @@ public:
 
 
 template<class T>
-soft_ptr<T> soft_from(T* object)
+soft_from_result<T> soft_from(T* object)
 {
 	static_assert(std::is_same_v<decltype(T::made_exposed_), bool>, "must inherit from enable_soft_from_this");
 	if (!object || object->made_exposed_ == false)
@@ -167,12 +415,14 @@ soft_ptr<T> soft_from(T* object)
 
 
 //exposed_ptr: a unique_ptr that can be weakly referenced
-template<class T>
+//Destroy picks when the object is destroyed once the owner lets go, see destroy_now and destroy_deferred
+template<class T, class Destroy>
 class exposed_ptr
 {
 	detail_::softctrl<T>* ptr_ = nullptr;
-	template<class T> friend class exposed_ptr;
+	template<class U, class D> friend class exposed_ptr;
 	template<class T> friend class soft_ptr;
+	template<class U, int64_t N> friend class exposed_pool;
 public:
 	exposed_ptr() = default;
 	exposed_ptr(nullptr_t) {};
@@ -183,22 +433,29 @@ public:
 		a.ptr_ = nullptr;
 	}
 	template<class U>
-	exposed_ptr(exposed_ptr<U>&& a)
+	exposed_ptr(exposed_ptr<U, Destroy>&& a)
 	{
 		static_assert(std::is_base_of<T, U>::value, "Invalid type");
 		ptr_ = reinterpret_cast<decltype(ptr_)>(a.ptr_);
 		a.ptr_ = nullptr;
 	}
+	//the control block comes from this thread's pool for blocks of its size
 	template<class... Args>
 	static exposed_ptr make(Args&&... args)
 	{
-		exposed_ptr result;
-		result.ptr_ = new detail_::softctrl<T>();
-		result.ptr_->soft_count_ = 0;
-		result.ptr_->valid_ = true;
-		new (&result.ptr_->value_) T(std::forward<Args>(args)...);
-		result.ptr_->mark_exposed<T>();
-		return result;
+		auto ctrl = new(detail_::softctrl_pool<T>::local().allocate()) detail_::softctrl<T>();
+		ctrl->release_ = &release_pooled;
+		return construct(ctrl, std::forward<Args>(args)...);
+	}
+	//the control block comes from alloc, a copy of which is kept in the block until it is freed
+	template<class Alloc, class... Args>
+	static exposed_ptr allocate(const Alloc& alloc, Args&&... args)
+	{
+		using block = detail_::softctrl_alloc<T, Alloc>;
+		typename block::self_alloc block_alloc(alloc);
+		auto ctrl = new(std::allocator_traits<typename block::self_alloc>::allocate(block_alloc, 1)) block(alloc);
+		ctrl->release_ = &block::release;
+		return construct(ctrl, std::forward<Args>(args)...);
 	}
 	exposed_ptr& operator=(exposed_ptr&& a)
 	{
@@ -229,7 +486,7 @@ public:
 	bool operator!() const { return !static_cast<bool>(*this); }
 	auto soft_count() const
 	{
-		return ptr_ ? ptr_->soft_count_ : nullptr;
+		return ptr_ ? ptr_->soft_count_ : 0;
 	}
 	soft_ptr<T> soft() const
 	{
@@ -240,11 +497,7 @@ public:
 		if (!ptr_) return;
 
 		ptr_->valid_ = false;
-		get()->~T();
-		if (ptr_->soft_count_ == 0)
-		{
-			delete ptr_;
-		}
+		Destroy::dispose(ptr_);
 		ptr_ = nullptr;
 	}
 
@@ -269,25 +522,49 @@ public:
 	{
 		return a.get() != b.get();
 	}
+private:
+	template<class... Args>
+	static exposed_ptr construct(detail_::softctrl<T>* ctrl, Args&&... args)
+	{
+		exposed_ptr result;
+		result.ptr_ = ctrl;
+		result.ptr_->soft_count_ = 0;
+		result.ptr_->valid_ = true;
+		new (&result.ptr_->value_) T(std::forward<Args>(args)...);
+		result.ptr_->mark_exposed<T>();
+		return result;
+	}
+	static void release_pooled(void* ctrl) noexcept(true)
+	{
+		((detail_::softctrl<T>*)ctrl)->~softctrl();
+		detail_::softctrl_pool<T>::local().release(ctrl);
+	}
 };
 
-template<class T>
-bool operator==(const exposed_ptr<T>& a, const soft_ptr<T>& b)
+//exposed_ptr whose control block is allocated with alloc, like std::allocate_shared
+template<class T, class Alloc, class... Args>
+exposed_ptr<T> allocate_exposed(const Alloc& alloc, Args&&... args)
+{
+	return exposed_ptr<T>::allocate(alloc, std::forward<Args>(args)...);
+}
+
+template<class T, class D>
+bool operator==(const exposed_ptr<T, D>& a, const soft_ptr<T>& b)
 {
 	return a.get() == b.get();
 }
-template<class T>
-bool operator==(const soft_ptr<T>& a, const exposed_ptr<T>& b)
+template<class T, class D>
+bool operator==(const soft_ptr<T>& a, const exposed_ptr<T, D>& b)
 {
 	return a.get() == b.get();
 }
-template<class T>
-bool operator!=(const exposed_ptr<T>& a, const soft_ptr<T>& b)
+template<class T, class D>
+bool operator!=(const exposed_ptr<T, D>& a, const soft_ptr<T>& b)
 {
 	return a.get() != b.get();
 }
-template<class T>
-bool operator!=(const soft_ptr<T>& a, const exposed_ptr<T>& b)
+template<class T, class D>
+bool operator!=(const soft_ptr<T>& a, const exposed_ptr<T, D>& b)
 {
 	return a.get()!= b.get();
 }
\ No newline at end of file
@@ -0,0 +1,192 @@
+#pragma once
+#include "exposed_ptr.h"
+
+template<class T> class intrusive_soft_ptr;
+
+namespace detail_
+{
+	struct intrusive_soft_link
+	{
+		enable_intrusive_soft_from_this* target_ = nullptr;
+		intrusive_soft_link* prev_ = nullptr;
+		intrusive_soft_link* next_ = nullptr;
+	};
+}
+
+//base for objects that hand out soft references without a control block
+//the object keeps its references in an intrusive list and empties them when it is destroyed,
+//so it can live anywhere: in a varray, on the stack or in an arena
+//references follow moves, so they survive relocation and track the value through erase and swap
+//copies start without references, copy assignment leaves the target's references alone
+//single threaded, like soft_ptr
+class enable_intrusive_soft_from_this
+{
+	template<class T> friend class intrusive_soft_ptr;
+	detail_::intrusive_soft_link* soft_head_ = nullptr;
+	uint32_t soft_count_ = 0;
+
+	void link(detail_::intrusive_soft_link* l) noexcept(true)
+	{
+		l->target_ = this;
+		l->prev_ = nullptr;
+		l->next_ = soft_head_;
+		if (soft_head_) soft_head_->prev_ = l;
+		soft_head_ = l;
+		++soft_count_;
+	}
+	void unlink(detail_::intrusive_soft_link* l) noexcept(true)
+	{
+		if (l->prev_) l->prev_->next_ = l->next_;
+		else soft_head_ = l->next_;
+		if (l->next_) l->next_->prev_ = l->prev_;
+		l->target_ = nullptr;
+		--soft_count_;
+	}
+	void detach_all() noexcept(true)
+	{
+		for (auto l = soft_head_; l; l = l->next_)
+		{
+			l->target_ = nullptr;
+		}
+		soft_head_ = nullptr;
+		soft_count_ = 0;
+	}
+	void take_all(enable_intrusive_soft_from_this& other) noexcept(true)
+	{
+		for (auto l = other.soft_head_; l; l = l->next_)
+		{
+			l->target_ = this;
+		}
+		soft_head_ = other.soft_head_;
+		soft_count_ = other.soft_count_;
+		other.soft_head_ = nullptr;
+		other.soft_count_ = 0;
+	}
+protected:
+	enable_intrusive_soft_from_this() = default;
+	enable_intrusive_soft_from_this(const enable_intrusive_soft_from_this&) noexcept(true)
+	{}
+	enable_intrusive_soft_from_this(enable_intrusive_soft_from_this&& other) noexcept(true)
+	{
+		take_all(other);
+	}
+	enable_intrusive_soft_from_this& operator=(const enable_intrusive_soft_from_this&) noexcept(true)
+	{
+		return *this;
+	}
+	enable_intrusive_soft_from_this& operator=(enable_intrusive_soft_from_this&& other) noexcept(true)
+	{
+		if (this != &other)
+		{
+			detach_all();
+			take_all(other);
+		}
+		return *this;
+	}
+	~enable_intrusive_soft_from_this()
+	{
+		detach_all();
+	}
+public:
+	uint32_t soft_count() const noexcept(true)
+	{
+		return soft_count_;
+	}
+};
+
+//intrusive_soft_ptr: soft_ptr to an enable_intrusive_soft_from_this object, nulled when the object dies
+template<class T>
+class intrusive_soft_ptr : detail_::intrusive_soft_link
+{
+	static_assert(std::is_base_of<enable_intrusive_soft_from_this, T>::value, "must inherit from enable_intrusive_soft_from_this");
+	void reset(T* object) noexcept(true)
+	{
+		clear();
+		if (object) static_cast<enable_intrusive_soft_from_this*>(object)->link(this);
+	}
+public:
+	intrusive_soft_ptr() = default;
+	intrusive_soft_ptr(nullptr_t) {}
+	explicit intrusive_soft_ptr(T* object)
+	{
+		reset(object);
+	}
+	intrusive_soft_ptr(const intrusive_soft_ptr& a)
+	{
+		reset(a.get());
+	}
+	intrusive_soft_ptr(intrusive_soft_ptr&& a)
+	{
+		reset(a.get());
+		a.clear();
+	}
+	intrusive_soft_ptr& operator=(const intrusive_soft_ptr& a)
+	{
+		if (this != &a) reset(a.get());
+		return *this;
+	}
+	intrusive_soft_ptr& operator=(intrusive_soft_ptr&& a)
+	{
+		if (this != &a)
+		{
+			reset(a.get());
+			a.clear();
+		}
+		return *this;
+	}
+	intrusive_soft_ptr& operator=(nullptr_t)
+	{
+		clear();
+		return *this;
+	}
+	T* get() const
+	{
+		return static_cast<T*>(target_);
+	}
+	T& operator*() const
+	{
+		return *get();
+	}
+	T* operator->() const
+	{
+		return get();
+	}
+	explicit operator bool() const { return target_ != nullptr; }
+	bool operator!() const { return target_ == nullptr; }
+	auto soft_count() const
+	{
+		return target_ ? target_->soft_count() : 0;
+	}
+	void clear()
+	{
+		if (!target_) return;
+		target_->unlink(this);
+	}
+	~intrusive_soft_ptr()
+	{
+		clear();
+	}
+	friend bool operator==(const intrusive_soft_ptr& a, nullptr_t b)
+	{
+		return a.get() == b;
+	}
+	friend bool operator!=(const intrusive_soft_ptr& a, nullptr_t b)
+	{
+		return a.get() != b;
+	}
+	friend bool operator==(const intrusive_soft_ptr& a, const intrusive_soft_ptr& b)
+	{
+		return a.get() == b.get();
+	}
+	friend bool operator!=(const intrusive_soft_ptr& a, const intrusive_soft_ptr& b)
+	{
+		return a.get() != b.get();
+	}
+};
+
+//intrusive counterpart of soft_from, works for any live object
+template<class T>
+std::enable_if_t<std::is_base_of<enable_intrusive_soft_from_this, T>::value, intrusive_soft_ptr<T>> soft_from(T* object)
+{
+	return intrusive_soft_ptr<T>(object);
+}
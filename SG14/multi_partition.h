@@ -0,0 +1,70 @@
+#pragma once
+#include "varray.h"
+
+namespace stdext
+{
+	namespace detail_
+	{
+		//next[c + 1] holds the size of bucket c on entry, next[0] is zero
+		//moves each misplaced element straight into its bucket by following permutation cycles, as in American flag sort,
+		//class_at(i) returns the bucket of the element at offset i, it is only asked about elements not moved yet
+		//returns the k + 1 bucket boundaries
+		template<class RandomIt, class ClassAt>
+		varray<RandomIt> place_buckets(RandomIt first, int64_t k, varray<int64_t>& next, ClassAt class_at)
+		{
+			for (int64_t b = 0; b < k; ++b)
+			{
+				next[b + 1] += next[b];
+			}
+			varray<RandomIt> bounds;
+			bounds.grow_capacity_exact(k + 1);
+			for (int64_t b = 0; b <= k; ++b)
+			{
+				bounds.push_back(first + next[b]);
+			}
+			for (int64_t b = 0; b < k; ++b)
+			{
+				auto end = bounds[b + 1] - first;
+				while (next[b] < end)
+				{
+					auto c = int64_t(class_at(next[b]));
+					if (c == b)
+					{
+						++next[b];
+						continue;
+					}
+					//buckets before b are complete, so the cycle ends back here
+					auto held = std::move(first[next[b]]);
+					do
+					{
+						using std::swap;
+						auto to = next[c]++;
+						auto displaced = int64_t(class_at(to));
+						swap(held, first[to]);
+						c = displaced;
+					} while (c != b);
+					first[next[b]++] = std::move(held);
+				}
+			}
+			return bounds;
+		}
+	}
+
+	//reorders [first, last) into k buckets by classifier(element), which must return a value in [0, k)
+	//one pass counts the buckets, a second moves each misplaced element straight into its bucket, so the cost does not grow with k
+	//returns the k + 1 bucket boundaries, the order inside a bucket is unspecified
+	//classifier is called up to twice per element
+	template<class RandomIt, class Classifier>
+	varray<RandomIt> multi_partition(RandomIt first, RandomIt last, int64_t k, Classifier classifier)
+	{
+		varray<int64_t> next;
+		next.resize(k + 1);
+		for (auto it = first; it != last; ++it)
+		{
+			auto c = int64_t(classifier(*it));
+			assert(c >= 0 && c < k);
+			++next[c + 1];
+		}
+		return detail_::place_buckets(first, k, next, [&](int64_t i) { return classifier(first[i]); });
+	}
+}
@@ -0,0 +1,237 @@
+#pragma once
+#include <thread>
+#include "algorithm_ext.h"
+#include "multi_partition.h"
+#include "varray.h"
+
+//execution policy overloads of the algorithm_ext algorithms for random access ranges
+//each worker runs the sequential algorithm on its own block, then the blocks are stitched together
+//the policies are local because <execution> is not available on every toolchain this builds with
+namespace stdext
+{
+	struct sequenced_policy
+	{};
+	//threads 0 uses every hardware thread, ranges are never split into blocks smaller than min_block
+	struct parallel_policy
+	{
+		int64_t threads = 0;
+		int64_t min_block = int64_t(1) << 14;
+
+		constexpr parallel_policy on(int64_t thread_count) const
+		{
+			return { thread_count, min_block };
+		}
+	};
+	constexpr sequenced_policy seq{};
+	constexpr parallel_policy par{};
+
+	namespace detail_
+	{
+		inline int64_t block_count(const parallel_policy& policy, int64_t n)
+		{
+			auto threads = policy.threads > 0 ? policy.threads : std::max<int64_t>(1, std::thread::hardware_concurrency());
+			return std::max<int64_t>(1, std::min(threads, n / std::max<int64_t>(1, policy.min_block)));
+		}
+		inline int64_t block_begin(int64_t n, int64_t blocks, int64_t i)
+		{
+			return n * i / blocks;
+		}
+
+		//calls f(i) for i in [0, count) on count threads, the caller runs f(0)
+		template<class F>
+		void run_blocks(int64_t count, F&& f)
+		{
+			varray<std::thread> workers;
+			workers.grow_capacity_exact(count - 1);
+			for (int64_t i = 1; i < count; ++i)
+			{
+				workers.emplace_back([&f, i] { f(i); });
+			}
+			f(0);
+			for (auto& w : workers)
+			{
+				w.join();
+			}
+		}
+
+		struct offset_range
+		{
+			int64_t begin_;
+			int64_t size_;
+		};
+		//walks a list of ranges as if they were one sequence of offsets
+		class range_cursor
+		{
+			const offset_range* range_;
+			int64_t offset_ = 0;
+		public:
+			range_cursor(const varray<offset_range>& ranges, int64_t skip)
+				: range_(ranges.begin())
+			{
+				for (; skip >= range_->size_; ++range_)
+				{
+					skip -= range_->size_;
+				}
+				offset_ = skip;
+			}
+			int64_t position() const
+			{
+				return range_->begin_ + offset_;
+			}
+			void advance()
+			{
+				if (++offset_ == range_->size_)
+				{
+					++range_;
+					offset_ = 0;
+				}
+			}
+		};
+
+		//each block of [first, first + n) is split into [selected, rejected) at kept_ends[i]
+		//transfers every selected element lying past the total selected count into a rejected slot before it
+		//only misplaced elements are touched, once each, so the minimal moves of unstable_remove_if are kept
+		template<class RandomIt, class Transfer>
+		RandomIt gather_blocks(const parallel_policy& policy, RandomIt first, int64_t n, const varray<int64_t>& kept_ends, Transfer transfer)
+		{
+			auto blocks = kept_ends.size();
+			int64_t kept = 0;
+			for (int64_t i = 0; i < blocks; ++i)
+			{
+				kept += kept_ends[i] - block_begin(n, blocks, i);
+			}
+			varray<offset_range> holes;
+			varray<offset_range> sources;
+			int64_t moves = 0;
+			for (int64_t i = 0; i < blocks; ++i)
+			{
+				auto b = block_begin(n, blocks, i);
+				auto e = block_begin(n, blocks, i + 1);
+				auto k = kept_ends[i];
+				if (k < std::min(e, kept))
+				{
+					holes.push_back({ k, std::min(e, kept) - k });
+					moves += holes.back().size_;
+				}
+				if (k > kept)
+				{
+					auto from = std::max(b, kept);
+					sources.push_back({ from, k - from });
+				}
+			}
+			if (moves > 0)
+			{
+				auto workers = block_count(policy, moves);
+				run_blocks(workers, [&](int64_t w)
+				{
+					auto lo = block_begin(moves, workers, w);
+					auto hi = block_begin(moves, workers, w + 1);
+					if (lo == hi)
+					{
+						return;
+					}
+					range_cursor hole(holes, lo);
+					range_cursor source(sources, lo);
+					for (auto m = lo; m < hi; ++m)
+					{
+						transfer(first + source.position(), first + hole.position());
+						hole.advance();
+						source.advance();
+					}
+				});
+			}
+			return first + kept;
+		}
+
+		//runs partition_block on every block and gathers the results
+		template<class RandomIt, class PartitionBlock, class Transfer>
+		RandomIt parallel_partition(const parallel_policy& policy, RandomIt first, RandomIt last, PartitionBlock partition_block, Transfer transfer)
+		{
+			int64_t n = last - first;
+			auto blocks = block_count(policy, n);
+			if (blocks == 1)
+			{
+				return partition_block(first, last);
+			}
+			varray<int64_t> kept_ends;
+			kept_ends.resize(blocks);
+			run_blocks(blocks, [&](int64_t i)
+			{
+				kept_ends[i] = partition_block(first + block_begin(n, blocks, i), first + block_begin(n, blocks, i + 1)) - first;
+			});
+			return gather_blocks(policy, first, n, kept_ends, transfer);
+		}
+	}
+
+	template<class BidirIt, class UnaryPredicate>
+	BidirIt unstable_remove_if(sequenced_policy, BidirIt first, BidirIt last, UnaryPredicate p)
+	{
+		return stdext::unstable_remove_if(first, last, p);
+	}
+	//p is called concurrently and must not modify shared state
+	template<class RandomIt, class UnaryPredicate>
+	RandomIt unstable_remove_if(const parallel_policy& policy, RandomIt first, RandomIt last, UnaryPredicate p)
+	{
+		return detail_::parallel_partition(policy, first, last,
+			[&](RandomIt b, RandomIt e) { return stdext::unstable_remove_if(b, e, p); },
+			[](RandomIt from, RandomIt to) { *to = std::move(*from); });
+	}
+
+	template<class BidirIt, class UnaryPredicate>
+	BidirIt partition(sequenced_policy, BidirIt first, BidirIt last, UnaryPredicate p)
+	{
+		return stdext::partition(first, last, p);
+	}
+	//p is called concurrently and must not modify shared state
+	template<class RandomIt, class UnaryPredicate>
+	RandomIt partition(const parallel_policy& policy, RandomIt first, RandomIt last, UnaryPredicate p)
+	{
+		return detail_::parallel_partition(policy, first, last,
+			[&](RandomIt b, RandomIt e) { return stdext::partition(b, e, p); },
+			[](RandomIt from, RandomIt to) { std::iter_swap(from, to); });
+	}
+
+	template<class RandomIt, class Classifier>
+	varray<RandomIt> multi_partition(sequenced_policy, RandomIt first, RandomIt last, int64_t k, Classifier classifier)
+	{
+		return stdext::multi_partition(first, last, k, classifier);
+	}
+	//blocks are classified and counted in parallel, the classes are kept so the cycle pass runs without calling
+	//classifier again, that pass is sequential and costs 4 bytes per element of scratch
+	//classifier is called concurrently, once per element, and must not modify shared state
+	template<class RandomIt, class Classifier>
+	varray<RandomIt> multi_partition(const parallel_policy& policy, RandomIt first, RandomIt last, int64_t k, Classifier classifier)
+	{
+		int64_t n = last - first;
+		auto blocks = detail_::block_count(policy, n);
+		if (blocks == 1)
+		{
+			return stdext::multi_partition(first, last, k, classifier);
+		}
+		varray<uint32_t> classes;
+		classes.resize_uninitialized(n);
+		varray<int64_t> counts;
+		counts.resize(blocks * k);
+		detail_::run_blocks(blocks, [&](int64_t i)
+		{
+			auto block_counts = counts.begin() + i * k;
+			for (auto j = detail_::block_begin(n, blocks, i); j < detail_::block_begin(n, blocks, i + 1); ++j)
+			{
+				auto c = uint32_t(classifier(first[j]));
+				assert(c < uint64_t(k));
+				classes[j] = c;
+				++block_counts[c];
+			}
+		});
+		varray<int64_t> next;
+		next.resize(k + 1);
+		for (int64_t i = 0; i < blocks; ++i)
+		{
+			for (int64_t c = 0; c < k; ++c)
+			{
+				next[c + 1] += counts[i * k + c];
+			}
+		}
+		return detail_::place_buckets(first, k, next, [&](int64_t i) { return classes[i]; });
+	}
+}
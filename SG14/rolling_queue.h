@@ -0,0 +1,324 @@
+#pragma once
+#include <atomic>
+#include "span.h"
+#include "varray_allocators.h"
+
+namespace detail_
+{
+	//separates indices written by different threads so they never share a cache line
+	constexpr size_t queue_cache_line = 64;
+}
+
+//bounded lock free queue for exactly one producer thread and one consumer thread
+//storage comes from Allocator::typed<T> and its capacity must be a power of two
+//push_n and pop_n transfer whole spans with at most two contiguous copies and one atomic publish
+template<typename T, typename Allocator = heap_allocator<grow_default<32>> >
+class spsc_rolling_queue
+{
+	typename Allocator::template typed<T> storage_;
+	int64_t mask_;
+
+	//written by the consumer
+	alignas(detail_::queue_cache_line) std::atomic<int64_t> head_;
+	int64_t cached_tail_;
+	//written by the producer
+	alignas(detail_::queue_cache_line) std::atomic<int64_t> tail_;
+	int64_t cached_head_;
+public:
+	using ElementT = T;
+	//capacity is rounded up to a power of two, fixed size allocators ignore it
+	explicit spsc_rolling_queue(int64_t capacity)
+		: head_(0), cached_tail_(0), tail_(0), cached_head_(0)
+	{
+		auto allocated = storage_.realloc_exact(0, math::next_power_of_two(capacity), 0);
+		assert(allocated > 0 && (allocated & (allocated - 1)) == 0);
+		mask_ = allocated - 1;
+	}
+	spsc_rolling_queue(const spsc_rolling_queue&) = delete;
+	spsc_rolling_queue& operator=(const spsc_rolling_queue&) = delete;
+	~spsc_rolling_queue()
+	{
+		auto head = head_.load(std::memory_order_relaxed);
+		auto tail = tail_.load(std::memory_order_relaxed);
+		for (; head != tail; ++head)
+		{
+			stdext::destroy_at(slot(head));
+		}
+		storage_.free(0, capacity());
+	}
+
+	int64_t capacity() const noexcept(true)
+	{
+		return mask_ + 1;
+	}
+	//exact only when called from the producer or consumer while the other is idle
+	int64_t size() const noexcept(true)
+	{
+		return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+	}
+	bool empty() const noexcept(true)
+	{
+		return size() == 0;
+	}
+
+	//producer
+	bool try_push_back(const T& Item)
+	{
+		return try_emplace_back(Item);
+	}
+	bool try_push_back(T&& Item)
+	{
+		return try_emplace_back(std::move(Item));
+	}
+	template<class... Args>
+	bool try_emplace_back(Args&&... args)
+	{
+		auto tail = tail_.load(std::memory_order_relaxed);
+		if (free_slots(tail, 1) < 1)
+		{
+			return false;
+		}
+		new(slot(tail)) T(std::forward<Args>(args)...);
+		tail_.store(tail + 1, std::memory_order_release);
+		return true;
+	}
+	//copies as many leading items as fit and returns how many were pushed
+	int64_t push_n(span<const T> items)
+	{
+		auto tail = tail_.load(std::memory_order_relaxed);
+		auto n = std::min<int64_t>(items.size(), free_slots(tail, items.size()));
+		if (n > 0)
+		{
+			auto first = tail & mask_;
+			auto contiguous = std::min(n, capacity() - first);
+			stdext::bulk_copy(items.begin(), contiguous, storage_.data() + first);
+			stdext::bulk_copy(items.begin() + contiguous, n - contiguous, storage_.data());
+			tail_.store(tail + n, std::memory_order_release);
+		}
+		return n;
+	}
+
+	//consumer
+	bool try_pop_front(T& out)
+	{
+		auto head = head_.load(std::memory_order_relaxed);
+		if (used_slots(head, 1) < 1)
+		{
+			return false;
+		}
+		auto at = slot(head);
+		out = std::move(*at);
+		stdext::destroy_at(at);
+		head_.store(head + 1, std::memory_order_release);
+		return true;
+	}
+	//moves up to out.size() items into out and returns how many were popped
+	int64_t pop_n(span<T> out)
+	{
+		auto head = head_.load(std::memory_order_relaxed);
+		auto n = std::min<int64_t>(out.size(), used_slots(head, out.size()));
+		if (n > 0)
+		{
+			auto first = head & mask_;
+			auto contiguous = std::min(n, capacity() - first);
+			auto data = storage_.data();
+			std::move(data + first, data + first + contiguous, out.begin());
+			std::move(data, data + n - contiguous, out.begin() + contiguous);
+			stdext::destroy(data + first, data + first + contiguous);
+			stdext::destroy(data, data + n - contiguous);
+			head_.store(head + n, std::memory_order_release);
+		}
+		return n;
+	}
+
+private:
+	T* slot(int64_t index) const
+	{
+		return storage_.data() + (index & mask_);
+	}
+	//only reload the other thread's index when the cached one says there is not enough room
+	int64_t free_slots(int64_t tail, int64_t wanted)
+	{
+		auto available = capacity() - (tail - cached_head_);
+		if (available < wanted)
+		{
+			cached_head_ = head_.load(std::memory_order_acquire);
+			available = capacity() - (tail - cached_head_);
+		}
+		return available;
+	}
+	int64_t used_slots(int64_t head, int64_t wanted)
+	{
+		auto available = cached_tail_ - head;
+		if (available < wanted)
+		{
+			cached_tail_ = tail_.load(std::memory_order_acquire);
+			available = cached_tail_ - head;
+		}
+		return available;
+	}
+};
+
+//bounded lock free queue for any number of producer and consumer threads
+//each slot carries a sequence number telling whether it is ready for the next push or pop (Vyukov's bounded queue)
+//slots come from Allocator::typed, capacity must be a power of two
+template<typename T, typename Allocator = heap_allocator<grow_default<32>> >
+class mpmc_rolling_queue
+{
+	struct cell
+	{
+		std::atomic<int64_t> sequence_;
+		typename std::aligned_storage<sizeof(T), alignof(T)>::type value_;
+
+		explicit cell(int64_t sequence)
+			: sequence_(sequence)
+		{}
+		//allocators instantiate their relocation path, but the queue never reallocates
+		cell(cell&& other)
+			: sequence_(other.sequence_.load(std::memory_order_relaxed))
+		{}
+	};
+	typename Allocator::template typed<cell> storage_;
+	int64_t mask_;
+
+	alignas(detail_::queue_cache_line) std::atomic<int64_t> tail_;
+	alignas(detail_::queue_cache_line) std::atomic<int64_t> head_;
+public:
+	using ElementT = T;
+	//capacity is rounded up to a power of two, fixed size allocators ignore it
+	explicit mpmc_rolling_queue(int64_t capacity)
+		: tail_(0), head_(0)
+	{
+		auto allocated = storage_.realloc_exact(0, math::next_power_of_two(capacity), 0);
+		assert(allocated > 0 && (allocated & (allocated - 1)) == 0);
+		mask_ = allocated - 1;
+		auto cells = storage_.data();
+		for (int64_t i = 0; i < allocated; ++i)
+		{
+			new(&cells[i]) cell(i);
+		}
+	}
+	mpmc_rolling_queue(const mpmc_rolling_queue&) = delete;
+	mpmc_rolling_queue& operator=(const mpmc_rolling_queue&) = delete;
+	~mpmc_rolling_queue()
+	{
+		auto head = head_.load(std::memory_order_relaxed);
+		auto tail = tail_.load(std::memory_order_relaxed);
+		for (; head != tail; ++head)
+		{
+			stdext::destroy_at(value(storage_.data()[head & mask_]));
+		}
+		storage_.free(0, capacity());
+	}
+
+	int64_t capacity() const noexcept(true)
+	{
+		return mask_ + 1;
+	}
+	//a snapshot, other threads may change it immediately
+	int64_t size() const noexcept(true)
+	{
+		auto head = head_.load(std::memory_order_acquire);
+		return std::max<int64_t>(tail_.load(std::memory_order_acquire) - head, 0);
+	}
+	bool empty() const noexcept(true)
+	{
+		return size() == 0;
+	}
+
+	bool try_push_back(const T& Item)
+	{
+		return try_emplace_back(Item);
+	}
+	bool try_push_back(T&& Item)
+	{
+		return try_emplace_back(std::move(Item));
+	}
+	template<class... Args>
+	bool try_emplace_back(Args&&... args)
+	{
+		auto pos = tail_.load(std::memory_order_relaxed);
+		for (;;)
+		{
+			auto& c = storage_.data()[pos & mask_];
+			auto diff = c.sequence_.load(std::memory_order_acquire) - pos;
+			if (diff == 0)
+			{
+				if (tail_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+				{
+					new(value(c)) T(std::forward<Args>(args)...);
+					c.sequence_.store(pos + 1, std::memory_order_release);
+					return true;
+				}
+			}
+			else if (diff < 0)
+			{
+				//the slot still holds the item pushed one lap ago
+				return false;
+			}
+			else
+			{
+				pos = tail_.load(std::memory_order_relaxed);
+			}
+		}
+	}
+	bool try_pop_front(T& out)
+	{
+		auto pos = head_.load(std::memory_order_relaxed);
+		for (;;)
+		{
+			auto& c = storage_.data()[pos & mask_];
+			auto diff = c.sequence_.load(std::memory_order_acquire) - (pos + 1);
+			if (diff == 0)
+			{
+				if (head_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+				{
+					auto at = value(c);
+					out = std::move(*at);
+					stdext::destroy_at(at);
+					c.sequence_.store(pos + mask_ + 1, std::memory_order_release);
+					return true;
+				}
+			}
+			else if (diff < 0)
+			{
+				//nothing has been pushed into this slot yet
+				return false;
+			}
+			else
+			{
+				pos = head_.load(std::memory_order_relaxed);
+			}
+		}
+	}
+	//pushes leading items until the queue is full and returns how many were pushed
+	int64_t push_n(span<const T> items)
+	{
+		int64_t n = 0;
+		for (auto& item : items)
+		{
+			if (!try_push_back(item))
+				break;
+			++n;
+		}
+		return n;
+	}
+	//pops into out until it is full or the queue is empty and returns how many were popped
+	int64_t pop_n(span<T> out)
+	{
+		int64_t n = 0;
+		for (auto& item : out)
+		{
+			if (!try_pop_front(item))
+				break;
+			++n;
+		}
+		return n;
+	}
+
+private:
+	static T* value(cell& c)
+	{
+		return (T*)&c.value_;
+	}
+};
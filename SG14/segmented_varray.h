@@ -0,0 +1,210 @@
+#pragma once
+#include "varray.h"
+
+//array built from fixed size chunks, growing never moves existing elements so pointers to them stay valid
+//indexing is a shift and mask into the chunk directory, for_each_chunk hands out contiguous spans for inner loops
+//each chunk is one Allocator::typed<T> sized to exactly ChunkSize elements
+// provides no exception guarantees
+template<typename T, uint32_t ChunkSize = 1024, typename Allocator = heap_allocator<grow_default<32>> >
+class segmented_varray
+{
+	static_assert(ChunkSize > 0 && (ChunkSize & (ChunkSize - 1)) == 0, "ChunkSize must be a power of two");
+	static constexpr int64_t chunk_shift = math::floor_log2(ChunkSize);
+	static constexpr int64_t chunk_mask = ChunkSize - 1;
+
+	using storage_t = typename Allocator::template typed<T>;
+	struct chunk
+	{
+		T* data_;
+		storage_t* storage_;
+	};
+
+	int64_t count_ = 0;
+	varray<chunk> chunks_;
+public:
+	using ElementT = T;
+	segmented_varray() noexcept(true) = default;
+	segmented_varray(const segmented_varray& other)
+	{
+		*this += other;
+	}
+	segmented_varray(segmented_varray&& other) noexcept(true)
+		: count_(other.count_), chunks_(std::move(other.chunks_))
+	{
+		other.count_ = 0;
+	}
+	segmented_varray& operator=(const segmented_varray& other)
+	{
+		if (this != &other)
+		{
+			clear();
+			*this += other;
+		}
+		return *this;
+	}
+	segmented_varray& operator=(segmented_varray&& other) noexcept(true)
+	{
+		this->~segmented_varray();
+		new(this) segmented_varray(std::move(other));
+		return *this;
+	}
+	~segmented_varray() noexcept(true)
+	{
+		clear();
+		for (auto& c : chunks_)
+		{
+			c.storage_->free(0, ChunkSize);
+			delete c.storage_;
+		}
+	}
+
+	T& push_back(const T& Item)
+	{
+		return emplace_back(Item);
+	}
+	T& push_back(T&& Item)
+	{
+		return emplace_back(std::move(Item));
+	}
+	template<class... Args >
+	T& emplace_back(Args&&... args)
+	{
+		grow_capacity(count_ + 1);
+		auto at = address(count_);
+		new(at) T(std::forward<Args>(args)...);
+		++count_;
+		return *at;
+	}
+	T pop_back()
+	{
+		auto pos = address(count_ - 1);
+		auto Result = std::move(*pos);
+		erase_from_end(1);
+		return Result;
+	}
+	void operator+=(const segmented_varray& source)
+	{
+		grow_capacity(count_ + source.count_);
+		source.for_each_chunk([&](span<const T> items)
+		{
+			for (auto& item : items)
+			{
+				new(address(count_)) T(item);
+				++count_;
+			}
+		});
+	}
+
+	T& operator[](int64_t i)
+	{
+		assert(i >= 0 && (i<count_));
+		return *address(i);
+	}
+	const T& operator[](int64_t i) const
+	{
+		assert(i >= 0 && (i<count_));
+		return *address(i);
+	}
+	T& front()
+	{
+		return *address(0);
+	}
+	const T& front() const
+	{
+		return *address(0);
+	}
+	T& back()
+	{
+		return *address(count_ - 1);
+	}
+	const T& back() const
+	{
+		return *address(count_ - 1);
+	}
+
+	int64_t size() const noexcept(true)
+	{
+		return count_;
+	}
+	int64_t capacity() const noexcept(true)
+	{
+		return chunks_.size() * int64_t(ChunkSize);
+	}
+	int64_t slack() const noexcept(true)
+	{
+		return capacity() - count_;
+	}
+	int64_t chunk_count() const noexcept(true)
+	{
+		return (count_ + chunk_mask) >> chunk_shift;
+	}
+	//the live elements of chunk c, every chunk but the last is full
+	span<T> chunk_view(int64_t c)
+	{
+		assert(c >= 0 && c < chunk_count());
+		return span<T>(chunks_[c].data_, std::min<int64_t>(count_ - (c << chunk_shift), ChunkSize));
+	}
+	span<const T> chunk_view(int64_t c) const
+	{
+		assert(c >= 0 && c < chunk_count());
+		return span<const T>(chunks_[c].data_, std::min<int64_t>(count_ - (c << chunk_shift), ChunkSize));
+	}
+	//calls f with a span per chunk, in order
+	template<class F>
+	void for_each_chunk(F&& f)
+	{
+		for (int64_t c = 0, n = chunk_count(); c < n; ++c)
+		{
+			f(chunk_view(c));
+		}
+	}
+	template<class F>
+	void for_each_chunk(F&& f) const
+	{
+		for (int64_t c = 0, n = chunk_count(); c < n; ++c)
+		{
+			f(chunk_view(c));
+		}
+	}
+
+	//adds whole chunks until new_capacity elements fit, existing elements are untouched
+	void grow_capacity(int64_t new_capacity)
+	{
+		while (capacity() < new_capacity)
+		{
+			auto storage = new storage_t();
+			storage->realloc_exact(0, ChunkSize, 0);
+			chunks_.push_back(chunk{ storage->data(), storage });
+		}
+	}
+	int64_t erase_from_end(int64_t num)
+	{
+		assert(num >= 0 && num <= count_);
+		for (int64_t i = 0; i < num; ++i)
+		{
+			stdext::destroy_at(address(--count_));
+		}
+		return num;
+	}
+	//keeps the chunks for reuse, see shrink_to_fit
+	void clear()
+	{
+		erase_from_end(count_);
+	}
+	//releases chunks past the last one in use
+	void shrink_to_fit()
+	{
+		while (chunks_.size() > chunk_count())
+		{
+			auto c = chunks_.pop_back();
+			c.storage_->free(0, ChunkSize);
+			delete c.storage_;
+		}
+	}
+
+private:
+	T* address(int64_t i) const
+	{
+		return chunks_[i >> chunk_shift].data_ + (i & chunk_mask);
+	}
+};
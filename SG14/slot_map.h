@@ -0,0 +1,338 @@
+#pragma once
+#include "varray.h"
+
+//weak reference into a slot_map: a 32 bit slot index and the 32 bit generation it was issued with
+//a handle goes stale when its element is erased, and stays stale when the slot is reused
+struct slot_handle
+{
+	uint32_t index_ = UINT32_MAX;
+	uint32_t generation_ = 0;
+
+	friend bool operator==(slot_handle a, slot_handle b)
+	{
+		return a.index_ == b.index_ && a.generation_ == b.generation_;
+	}
+	friend bool operator!=(slot_handle a, slot_handle b)
+	{
+		return !(a == b);
+	}
+};
+
+template<typename T, typename Allocator> class slot_map;
+
+namespace detail_
+{
+	//the map currently holding the element, kept up to date by slot_map
+	struct slot_backlink
+	{
+		const void* slot_map_ = nullptr;
+	};
+}
+
+//base that makes soft_from(this) work for elements of a slot_map<T, Allocator>, returning a slot_ref
+//code written against enable_soft_from_this migrates by switching the base class, soft_from call sites stay as they are
+//the map records itself in the base on insertion and when it is copied or moved
+template<typename Allocator = heap_allocator<grow_default<32>> >
+class enable_slot_from_this : public detail_::slot_backlink
+{
+public:
+	using slot_allocator = Allocator;
+};
+
+//soft_ptr-like view of a slot_map handle, so code written against soft_ptr can switch containers
+//the map must outlive the reference
+template<typename T, typename Allocator = heap_allocator<grow_default<32>> >
+class slot_ref
+{
+	const slot_map<T, Allocator>* map_ = nullptr;
+	slot_handle handle_;
+public:
+	slot_ref() = default;
+	slot_ref(std::nullptr_t) {}
+	slot_ref(const slot_map<T, Allocator>& map, slot_handle handle)
+		: map_(&map), handle_(handle)
+	{}
+	T* get() const
+	{
+		return map_ ? const_cast<T*>(map_->get(handle_)) : nullptr;
+	}
+	T& operator*() const
+	{
+		return *get();
+	}
+	T* operator->() const
+	{
+		return get();
+	}
+	explicit operator bool() const { return get() != nullptr; }
+	bool operator!() const { return !static_cast<bool>(*this); }
+	slot_handle handle() const
+	{
+		return handle_;
+	}
+	friend bool operator==(const slot_ref& a, std::nullptr_t b)
+	{
+		return a.get() == b;
+	}
+	friend bool operator!=(const slot_ref& a, std::nullptr_t b)
+	{
+		return a.get() != b;
+	}
+	friend bool operator==(const slot_ref& a, const slot_ref& b)
+	{
+		return a.get() == b.get();
+	}
+	friend bool operator!=(const slot_ref& a, const slot_ref& b)
+	{
+		return a.get() != b.get();
+	}
+};
+
+//handle table keeping its elements densely packed for iteration
+//lookups are a bounds check and a generation compare, erased storage is reused immediately by
+//moving the last element into the hole, so element addresses are not stable, handles are
+//generations wrap after 2^32 erasures of one slot
+// provides no exception guarantees
+template<typename T, typename Allocator = heap_allocator<grow_default<32>> >
+class slot_map
+{
+	static constexpr uint32_t no_slot = UINT32_MAX;
+
+	//a live slot holds the dense index of its element, a free slot the next free slot
+	struct slot
+	{
+		uint32_t target_;
+		uint32_t generation_;
+	};
+
+	varray<T, Allocator> values_;
+	//slot of each dense element, kept parallel to values_
+	varray<uint32_t, Allocator> owners_;
+	varray<slot, Allocator> slots_;
+	uint32_t free_head_ = no_slot;
+
+public:
+	using handle = slot_handle;
+	using ref = slot_ref<T, Allocator>;
+
+	slot_map() noexcept(true) = default;
+	slot_map(const slot_map& other)
+		: values_(other.values_), owners_(other.owners_), slots_(other.slots_), free_head_(other.free_head_)
+	{
+		link_all();
+	}
+	slot_map(slot_map&& other) noexcept(true)
+		: values_(std::move(other.values_)), owners_(std::move(other.owners_)), slots_(std::move(other.slots_)), free_head_(other.free_head_)
+	{
+		other.free_head_ = no_slot;
+		link_all();
+	}
+	slot_map& operator=(const slot_map& other)
+	{
+		if (this != &other)
+		{
+			this->~slot_map();
+			new(this) slot_map(other);
+		}
+		return *this;
+	}
+	slot_map& operator=(slot_map&& other) noexcept(true)
+	{
+		if (this != &other)
+		{
+			this->~slot_map();
+			new(this) slot_map(std::move(other));
+		}
+		return *this;
+	}
+
+	handle insert(const T& item)
+	{
+		return emplace(item);
+	}
+	handle insert(T&& item)
+	{
+		return emplace(std::move(item));
+	}
+	template<class... Args>
+	handle emplace(Args&&... args)
+	{
+		uint32_t index;
+		if (free_head_ != no_slot)
+		{
+			index = free_head_;
+			free_head_ = slots_[index].target_;
+		}
+		else
+		{
+			assert(slots_.size() < no_slot);
+			index = uint32_t(slots_.size());
+			slots_.push_back(slot{ 0, 0 });
+		}
+		auto& s = slots_[index];
+		s.target_ = uint32_t(values_.size());
+		link(values_.emplace_back(std::forward<Args>(args)...));
+		owners_.push_back(index);
+		return { index, s.generation_ };
+	}
+
+	//returns false if h was already stale
+	bool erase(handle h)
+	{
+		if (!contains(h))
+		{
+			return false;
+		}
+		auto dense = slots_[h.index_].target_;
+		auto last = owners_.back();
+		values_.unstable_erase(values_.begin() + dense);
+		owners_.unstable_erase(owners_.begin() + dense);
+		if (last != h.index_)
+		{
+			slots_[last].target_ = dense;
+		}
+		release_slot(h.index_);
+		return true;
+	}
+	//erases every element matching p in one pass, moved elements keep their handles
+	template<class Pred>
+	int64_t erase_if(Pred p)
+	{
+		auto first = values_.begin();
+		auto kept_end = stdext::unstable_remove_if_with_relocation(first, values_.end(),
+			[&](T& item)
+			{
+				if (!p(item))
+				{
+					return false;
+				}
+				release_slot(owners_[&item - first]);
+				return true;
+			},
+			[&](T* from, T* to)
+			{
+				auto index = owners_[from - first];
+				owners_[to - first] = index;
+				slots_[index].target_ = uint32_t(to - first);
+			});
+		auto erased = values_.end() - kept_end;
+		values_.erase_from_end(erased);
+		owners_.erase_from_end(erased);
+		return erased;
+	}
+
+	bool contains(handle h) const noexcept(true)
+	{
+		return h.index_ < uint64_t(slots_.size()) && slots_[h.index_].generation_ == h.generation_;
+	}
+	T* get(handle h) noexcept(true)
+	{
+		return contains(h) ? values_.begin() + slots_[h.index_].target_ : nullptr;
+	}
+	const T* get(handle h) const noexcept(true)
+	{
+		return contains(h) ? values_.begin() + slots_[h.index_].target_ : nullptr;
+	}
+
+	//handle of an element of this map, the slot_map counterpart of soft_from(this)
+	handle handle_from(const T* object) const noexcept(true)
+	{
+		auto dense = object - values_.begin();
+		assert(dense >= 0 && dense < values_.size());
+		auto index = owners_[dense];
+		return { index, slots_[index].generation_ };
+	}
+	ref ref_from(const T* object) const noexcept(true)
+	{
+		return { *this, handle_from(object) };
+	}
+	ref make_ref(handle h) const noexcept(true)
+	{
+		return { *this, h };
+	}
+
+	//iterates the dense elements, erasing reorders them
+	T* begin() noexcept(true)
+	{
+		return values_.begin();
+	}
+	T* end() noexcept(true)
+	{
+		return values_.end();
+	}
+	const T* begin() const noexcept(true)
+	{
+		return values_.begin();
+	}
+	const T* end() const noexcept(true)
+	{
+		return values_.end();
+	}
+	int64_t size() const noexcept(true)
+	{
+		return values_.size();
+	}
+	bool empty() const noexcept(true)
+	{
+		return values_.size() == 0;
+	}
+	//stales every outstanding handle, slots are kept for reuse
+	void clear()
+	{
+		for (auto index : owners_)
+		{
+			release_slot(index);
+		}
+		values_.clear();
+		owners_.clear();
+	}
+	void reserve(int64_t n)
+	{
+		values_.grow_capacity_exact(n);
+		owners_.grow_capacity_exact(n);
+		slots_.grow_capacity_exact(n);
+	}
+private:
+	using backlinked = std::is_base_of<detail_::slot_backlink, T>;
+	void link(T& item, std::true_type) noexcept(true)
+	{
+		static_cast<detail_::slot_backlink&>(item).slot_map_ = this;
+	}
+	void link(T&, std::false_type) noexcept(true)
+	{}
+	void link(T& item) noexcept(true)
+	{
+		link(item, backlinked());
+	}
+	void link_all() noexcept(true)
+	{
+		if (backlinked::value)
+		{
+			for (auto& item : values_)
+			{
+				link(item);
+			}
+		}
+	}
+	//stales the slot's handles and puts it on the free list
+	void release_slot(uint32_t index) noexcept(true)
+	{
+		auto& s = slots_[index];
+		++s.generation_;
+		s.target_ = free_head_;
+		free_head_ = index;
+	}
+};
+
+//slot_map counterpart of soft_from, T must be the element type of the map holding object
+//an empty reference once object is no longer an element of that map
+template<class T>
+std::enable_if_t<std::is_base_of<detail_::slot_backlink, T>::value, slot_ref<T, typename T::slot_allocator>> soft_from(T* object)
+{
+	auto map = object ? static_cast<const slot_map<T, typename T::slot_allocator>*>(static_cast<const detail_::slot_backlink*>(object)->slot_map_) : nullptr;
+	if (!map || object < map->begin() || object >= map->end())
+	{
+		return nullptr;
+	}
+	return map->ref_from(object);
+}
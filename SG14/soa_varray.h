@@ -0,0 +1,223 @@
+#pragma once
+#include <tuple>
+#include <utility>
+#include "span.h"
+#include "varray_allocators.h"
+
+//structure of arrays: each field is stored in its own column under one shared size and capacity
+//columns are allocated through Allocator::typed<Field> exactly like varray's single buffer
+// provides no exception guarantees
+template<typename Allocator, typename... Fields>
+class basic_soa_varray
+{
+	static_assert(sizeof...(Fields) > 0, "soa_varray needs at least one field");
+	using indices = std::index_sequence_for<Fields...>;
+
+	int64_t count_;
+	int64_t capacity_;
+	std::tuple<typename Allocator::template typed<Fields>...> columns_;
+public:
+	template<size_t I>
+	using field_t = std::tuple_element_t<I, std::tuple<Fields...>>;
+
+	basic_soa_varray() noexcept(true)
+		: count_(0), capacity_(0)
+	{}
+	basic_soa_varray(const basic_soa_varray& other) noexcept(true)
+		: count_(other.count_), capacity_(other.count_)
+	{
+		for_each_column(other, [&](auto& column, auto& other_column) { column.assign(other_column, count_); });
+	}
+	basic_soa_varray(basic_soa_varray&& other) noexcept(true)
+		: count_(other.count_), capacity_(other.capacity_)
+	{
+		for_each_column(other, [&](auto& column, auto& other_column) { column.assign(std::move(other_column), count_); });
+		other.count_ = 0;
+		other.capacity_ = 0;
+	}
+	basic_soa_varray& operator=(basic_soa_varray&& other) noexcept(true)
+	{
+		this->~basic_soa_varray();
+		new(this) basic_soa_varray(std::move(other));
+		return *this;
+	}
+	basic_soa_varray& operator=(const basic_soa_varray& other) noexcept(true)
+	{
+		if (this != &other)
+		{
+			this->~basic_soa_varray();
+			new(this) basic_soa_varray(other);
+		}
+		return *this;
+	}
+	~basic_soa_varray() noexcept(true)
+	{
+		for_each_column([&](auto& column) { column.free(count_, capacity_); });
+	}
+
+	//appends one row, taking one value per field, and returns its index
+	template<class... Args>
+	int64_t push_back(Args&&... args)
+	{
+		static_assert(sizeof...(Args) == sizeof...(Fields), "push_back takes one value per field");
+		grow_capacity(count_ + 1);
+		construct_row(count_, indices(), std::forward<Args>(args)...);
+		return count_++;
+	}
+
+	template<size_t I>
+	span<field_t<I>> column()
+	{
+		return span<field_t<I>>(std::get<I>(columns_).data(), count_);
+	}
+	template<size_t I>
+	span<const field_t<I>> column() const
+	{
+		return span<const field_t<I>>(std::get<I>(columns_).data(), count_);
+	}
+	template<size_t I>
+	field_t<I>& get(int64_t i)
+	{
+		assert(i >= 0 && (i<count_));
+		return std::get<I>(columns_).data()[i];
+	}
+	template<size_t I>
+	const field_t<I>& get(int64_t i) const
+	{
+		assert(i >= 0 && (i<count_));
+		return std::get<I>(columns_).data()[i];
+	}
+
+	constexpr auto slack() const noexcept(true)
+	{
+		return capacity_ - count_;
+	}
+	constexpr auto capacity() const noexcept(true)
+	{
+		return capacity_;
+	}
+	constexpr auto size() const noexcept(true)
+	{
+		return count_;
+	}
+
+	//the first column applies the growth policy, the others are sized to match it exactly
+	void grow_capacity(int64_t new_capacity)
+	{
+		if (new_capacity > capacity_)
+		{
+			auto grown = std::get<0>(columns_).realloc(count_, new_capacity, capacity_);
+			realloc_tail_columns(grown, std::make_index_sequence<sizeof...(Fields) - 1>());
+			capacity_ = grown;
+		}
+	}
+	void clear()
+	{
+		erase_from_end(count_);
+	}
+	int64_t erase_from_end(int64_t num)
+	{
+		auto first = count_ - num;
+		for_each_column([&](auto& column) { stdext::destroy_n(column.data() + first, num); });
+		count_ = first;
+		return num;
+	}
+	void unstable_erase(int64_t index)
+	{
+		assert(index >= 0 && (index<count_));
+		auto last = count_ - 1;
+		if (index != last)
+		{
+			move_row(last, index);
+		}
+		erase_from_end(1);
+	}
+	//p is called with a const reference to every field of a row
+	template<class Pred>
+	int64_t erase_if(Pred p)
+	{
+		int64_t write = 0;
+		for (int64_t read = 0; read < count_; ++read)
+		{
+			if (!row_matches(p, read, indices()))
+			{
+				if (write != read)
+				{
+					move_row(read, write);
+				}
+				++write;
+			}
+		}
+		return erase_from_end(count_ - write);
+	}
+	//same sweep as stdext::unstable_remove_if, moving whole rows from the back into holes
+	template<class Pred>
+	int64_t unstable_erase_if(Pred p)
+	{
+		int64_t first = 0;
+		int64_t last = count_;
+		for (; ; ++first)
+		{
+			for (; first != last && !row_matches(p, first, indices()); ++first);
+			if (first == last)
+				break;
+
+			for (; first != --last && row_matches(p, last, indices()); );
+			if (first == last)
+				break;
+
+			move_row(last, first);
+		}
+		return erase_from_end(count_ - first);
+	}
+
+private:
+	template<class F>
+	void for_each_column(F&& f)
+	{
+		for_each_column(f, indices());
+	}
+	template<class F, size_t... I>
+	void for_each_column(F& f, std::index_sequence<I...>)
+	{
+		(f(std::get<I>(columns_)), ...);
+	}
+	template<class F>
+	void for_each_column(const basic_soa_varray& other, F&& f)
+	{
+		for_each_column(other, f, indices());
+	}
+	template<class F>
+	void for_each_column(basic_soa_varray& other, F&& f)
+	{
+		for_each_column(other, f, indices());
+	}
+	template<class Other, class F, size_t... I>
+	void for_each_column(Other& other, F& f, std::index_sequence<I...>)
+	{
+		(f(std::get<I>(columns_), std::get<I>(other.columns_)), ...);
+	}
+
+	template<size_t... I>
+	void realloc_tail_columns(int64_t new_capacity, std::index_sequence<I...>)
+	{
+		(std::get<I + 1>(columns_).realloc_exact(count_, new_capacity, capacity_), ...);
+	}
+	template<size_t... I, class... Args>
+	void construct_row(int64_t index, std::index_sequence<I...>, Args&&... args)
+	{
+		(new(std::get<I>(columns_).data() + index) Fields(std::forward<Args>(args)), ...);
+	}
+	template<class Pred, size_t... I>
+	bool row_matches(Pred& p, int64_t index, std::index_sequence<I...>) const
+	{
+		return p(static_cast<const Fields&>(std::get<I>(columns_).data()[index])...);
+	}
+	void move_row(int64_t from, int64_t to)
+	{
+		for_each_column([&](auto& column) { auto data = column.data(); data[to] = std::move(data[from]); });
+	}
+};
+
+template<typename... Fields>
+using soa_varray = basic_soa_varray<heap_allocator<grow_default<32>>, Fields...>;
@@ -1,4 +1,5 @@
 #pragma once
+#include "bulk_kernels.h"
 template<class T>
 struct span
 {
@@ -11,11 +12,11 @@ struct span
 	span(T* first, T* last)
 		:span(first, last - first)
 	{}
-	bool operator==(const span& other)
+	bool operator==(const span& other) const
 	{
-		return num_ == other.num_ && std::equal_range(begin(), end(), other.begin());
+		return num_ == other.num_ && stdext::bulk_equal(begin(), other.begin(), num_);
 	}
-	bool operator!=(const span& other)
+	bool operator!=(const span& other) const
 	{
 		return !(*this == other);
 	}
@@ -0,0 +1,437 @@
+#pragma once
+#include <initializer_list>
+#include <type_traits>
+#include "span.h"
+#include "algorithm_ext.h"
+
+namespace detail_
+{
+	//trivial elements live in a plain array, keeping static_varray trivially copyable and usable in constant expressions
+	//the array is value initialized because constexpr constructors must initialize every member
+	template<class T, uint32_t N, bool = std::is_trivial<T>::value>
+	struct static_varray_storage
+	{
+		int64_t count_ = 0;
+		T elements_[N] = {};
+
+		constexpr T* data() noexcept(true)
+		{
+			return elements_;
+		}
+		constexpr const T* data() const noexcept(true)
+		{
+			return elements_;
+		}
+		template<class... Args>
+		constexpr T& construct(T* at, Args&&... args)
+		{
+			*at = T(std::forward<Args>(args)...);
+			return *at;
+		}
+		constexpr void destroy(T*, T*) noexcept(true)
+		{
+		}
+	};
+
+	template<class T, uint32_t N>
+	struct static_varray_storage<T, N, false>
+	{
+		int64_t count_ = 0;
+		typename std::aligned_storage<sizeof(T), alignof(T)>::type buffer_[N];
+
+		static_varray_storage() = default;
+		static_varray_storage(const static_varray_storage& other)
+			: count_(other.count_)
+		{
+			stdext::bulk_copy(other.data(), count_, data());
+		}
+		static_varray_storage(static_varray_storage&& other)
+			: count_(other.count_)
+		{
+			stdext::uninitialized_move_n(other.data(), count_, data());
+		}
+		static_varray_storage& operator=(const static_varray_storage& other)
+		{
+			if (this != &other)
+			{
+				destroy(data(), data() + count_);
+				count_ = other.count_;
+				stdext::bulk_copy(other.data(), count_, data());
+			}
+			return *this;
+		}
+		static_varray_storage& operator=(static_varray_storage&& other)
+		{
+			if (this != &other)
+			{
+				destroy(data(), data() + count_);
+				count_ = other.count_;
+				stdext::uninitialized_move_n(other.data(), count_, data());
+			}
+			return *this;
+		}
+		~static_varray_storage()
+		{
+			destroy(data(), data() + count_);
+		}
+
+		T* data() noexcept(true)
+		{
+			return (T*)std::begin(buffer_);
+		}
+		const T* data() const noexcept(true)
+		{
+			return (const T*)std::begin(buffer_);
+		}
+		template<class... Args>
+		T& construct(T* at, Args&&... args)
+		{
+			return *new(at) T(std::forward<Args>(args)...);
+		}
+		void destroy(T* first, T* last)
+		{
+			stdext::destroy(first, last);
+		}
+	};
+}
+
+//fixed capacity array with the varray interface that never allocates
+//overflowing push_back asserts, try_push_back reports it instead
+template<typename T, uint32_t N>
+class static_varray : detail_::static_varray_storage<T, N>
+{
+	using storage = detail_::static_varray_storage<T, N>;
+	using storage::count_;
+public:
+	using ElementT = T;
+	constexpr static_varray() = default;
+	constexpr static_varray(std::initializer_list<T> items)
+	{
+		assert(items.size() <= N);
+		for (auto& item : items)
+		{
+			this->construct(end(), item);
+			++count_;
+		}
+	}
+	static_varray(span<const T> items)
+	{
+		*this += items;
+	}
+
+	T& push_front(const T& Item)
+	{
+		return insert(Item, 0);
+	}
+	T& push_front(T&& Item)
+	{
+		return insert(std::move(Item), 0);
+	}
+	constexpr T& push_back(const T& Item)
+	{
+		return emplace_back(Item);
+	}
+	constexpr T& push_back(T&& Item)
+	{
+		return emplace_back(std::move(Item));
+	}
+	template<class... Args >
+	constexpr T& emplace_back(Args&&... args)
+	{
+		assert(count_ < N);
+		auto& result = this->construct(end(), std::forward<Args>(args)...);
+		++count_;
+		return result;
+	}
+	constexpr bool try_push_back(const T& Item)
+	{
+		return try_emplace_back(Item);
+	}
+	constexpr bool try_push_back(T&& Item)
+	{
+		return try_emplace_back(std::move(Item));
+	}
+	template<class... Args >
+	constexpr bool try_emplace_back(Args&&... args)
+	{
+		if (count_ == N)
+		{
+			return false;
+		}
+		emplace_back(std::forward<Args>(args)...);
+		return true;
+	}
+
+	constexpr const T* begin() const noexcept(true)
+	{
+		return this->data();
+	}
+	constexpr T* begin() noexcept(true)
+	{
+		return this->data();
+	}
+	constexpr const T* end() const noexcept(true)
+	{
+		return begin() + count_;
+	}
+	constexpr T* end() noexcept(true)
+	{
+		return begin() + count_;
+	}
+
+	constexpr int64_t slack() const noexcept(true)
+	{
+		return N - count_;
+	}
+	constexpr int64_t capacity() const noexcept(true)
+	{
+		return N;
+	}
+	constexpr int64_t size() const noexcept(true)
+	{
+		return count_;
+	}
+
+	constexpr T& operator[](int64_t i)
+	{
+		assert(i >= 0 && (i<count_));
+		return begin()[i];
+	}
+	constexpr const T& operator[](int64_t i) const
+	{
+		assert(i >= 0 && (i<count_));
+		return begin()[i];
+	}
+	constexpr T& front()
+	{
+		return *(begin());
+	}
+	constexpr const T& front() const
+	{
+		return *(begin());
+	}
+	constexpr T& back()
+	{
+		return *(end() - 1);
+	}
+	constexpr const T& back() const
+	{
+		return *(end() - 1);
+	}
+	T pop_front()
+	{
+		auto b = begin();
+		auto Result = std::move(*b);
+		erase(b);
+		return Result;
+	}
+	constexpr T pop_back()
+	{
+		auto Result = std::move(back());
+		erase_from_end(1);
+		return Result;
+	}
+
+	bool operator==(span<const T> OtherArray) const
+	{
+		return size() == int64_t(OtherArray.size()) && stdext::bulk_equal(begin(), OtherArray.begin(), count_);
+	}
+	bool operator!=(span<const T> OtherArray) const
+	{
+		return !(*this == OtherArray);
+	}
+
+	T& insert(const T& item, int64_t index)
+	{
+		return emplace(index, item);
+	}
+	T& insert(T&& Item, int64_t index)
+	{
+		return emplace(index, std::move(Item));
+	}
+	//see varray::insert, items must not refer to elements of this array
+	T* insert(int64_t index, span<const T> items)
+	{
+		auto pos = open_gap(index, items.size());
+		stdext::bulk_copy(items.begin(), items.size(), pos);
+		return pos;
+	}
+	template<class ForwardIt>
+	T* insert(int64_t index, ForwardIt first, ForwardIt last)
+	{
+		auto pos = open_gap(index, std::distance(first, last));
+		std::uninitialized_copy(first, last, pos);
+		return pos;
+	}
+	template<class... Args>
+	T& emplace(int64_t index, Args&&... args)
+	{
+		T item(std::forward<Args>(args)...);
+		auto pos = open_gap(index, 1);
+		return this->construct(pos, std::move(item));
+	}
+
+	constexpr void clear()
+	{
+		erase_from_end(count_);
+	}
+	//capacity is fixed, these only check that the request fits so code written for varray keeps working
+	constexpr void clear(int64_t slack)
+	{
+		assert(slack <= N);
+		clear();
+	}
+	constexpr void grow_capacity(int64_t new_capacity)
+	{
+		assert(new_capacity <= N);
+	}
+	constexpr void grow_capacity_exact(int64_t new_capacity)
+	{
+		assert(new_capacity <= N);
+	}
+	constexpr void shrink_to_fit()
+	{
+	}
+	constexpr bool shrink_sparse(int64_t)
+	{
+		return false;
+	}
+	void operator+=(span<const T> source)
+	{
+		assert(count_ + int64_t(source.size()) <= N);
+		stdext::bulk_copy(source.begin(), source.size(), end());
+		count_ += source.size();
+	}
+
+	//see varray::append_uninitialized
+	span<T> append_uninitialized(int64_t n)
+	{
+		assert(count_ + n <= N);
+		auto first = end();
+		count_ += n;
+		return span<T>(first, n);
+	}
+	void resize_uninitialized(int64_t new_size)
+	{
+		if (new_size > count_)
+		{
+			append_uninitialized(new_size - count_);
+		}
+		else
+		{
+			erase_from_end(count_ - new_size);
+		}
+	}
+	void resize_default_init(int64_t new_size)
+	{
+		if (new_size > count_)
+		{
+			auto added = append_uninitialized(new_size - count_);
+			stdext::uninitialized_default_construct(added.begin(), added.end());
+		}
+		else
+		{
+			erase_from_end(count_ - new_size);
+		}
+	}
+	constexpr void resize(int64_t new_size)
+	{
+		resize(new_size, T());
+	}
+	constexpr void resize(int64_t new_size, const T& value)
+	{
+		assert(new_size >= 0 && new_size <= N);
+		while (count_ < new_size)
+		{
+			emplace_back(value);
+		}
+		erase_from_end(count_ - new_size);
+	}
+
+	constexpr void erase(T* at)
+	{
+		auto e = end();
+		for (auto i = at + 1; i != e; ++i)
+		{
+			*(i - 1) = std::move(*i);
+		}
+		erase_from_end(1);
+	}
+	constexpr int64_t erase_from_end(int64_t num)
+	{
+		this->destroy(end() - num, end());
+		count_ -= num;
+		return num;
+	}
+	int64_t erase(const T* first, const T* last)
+	{
+		std::move(const_cast<T*>(last), end(), const_cast<T*>(first));
+		return erase_from_end(last - first);
+	}
+	constexpr void unstable_erase(const T* at)
+	{
+		auto last = end() - 1;
+		if (at != last)
+		{
+			*const_cast<T*>(at) = std::move(*last);
+		}
+		erase_from_end(1);
+	}
+	int64_t unstable_erase(const T* first, const T* last)
+	{
+		auto e = end();
+		assert(last >= first && first >= begin() && last <= e);
+		auto count = last - first;
+		auto refill = std::min<int64_t>(count, e - last);
+		std::move(e - refill, e, const_cast<T*>(first));
+		return erase_from_end(count);
+	}
+	//shrink_divisor is accepted for varray compatibility and ignored
+	template<class Pred>
+	int64_t erase_if(Pred p, int64_t = 0)
+	{
+		return erase_from_end(end() - stdext::remove_if(begin(), end(), p));
+	}
+	template<class Pred>
+	int64_t unstable_erase_if(Pred p, int64_t = 0)
+	{
+		return erase_from_end(end() - stdext::unstable_remove_if(begin(), end(), p));
+	}
+
+	operator span<T>()
+	{
+		auto b = begin();
+		return span<T>(b, b + count_);
+	}
+	operator span<const T>() const
+	{
+		return view();
+	}
+	span<const T> view() const
+	{
+		auto b = begin();
+		return span<const T>(b, b + count_);
+	}
+
+private:
+	//see varray::open_gap
+	T* open_gap(int64_t index, int64_t n)
+	{
+		assert(index >= 0 && index <= count_ && n >= 0 && count_ + n <= N);
+		auto pos = begin() + index;
+		auto e = end();
+		if (e - pos > n)
+		{
+			stdext::uninitialized_move(e - n, e, e);
+			std::move_backward(pos, e - n, e);
+			this->destroy(pos, pos + n);
+		}
+		else
+		{
+			stdext::uninitialized_move(pos, e, pos + n);
+			this->destroy(pos, e);
+		}
+		count_ += n;
+		return pos;
+	}
+};
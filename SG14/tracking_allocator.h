@@ -0,0 +1,168 @@
+#pragma once
+#include <atomic>
+#include <ostream>
+#include "varray_allocators.h"
+
+//tracking_allocator<Inner, Tag> records per Tag how containers using Inner grow, move and waste memory
+//Tag is any type with a static const char* name() used in the report
+//define SG14_TRACK_ALLOCATIONS to enable it, otherwise tracking_allocator is Inner and allocation_report prints nothing
+//containers passed between translation units must see the same setting
+
+struct allocation_stats
+{
+	const char* name;
+	allocation_stats* next;
+	std::atomic<int64_t> realloc_calls;
+	std::atomic<int64_t> realloc_exact_calls;
+	std::atomic<int64_t> free_calls;
+	std::atomic<int64_t> copies;
+	//elements relocated into a new buffer by a reallocation
+	std::atomic<int64_t> bytes_moved;
+	//capacity bytes currently held by every container of this tag
+	std::atomic<int64_t> live_bytes;
+	std::atomic<int64_t> peak_live_bytes;
+	//largest capacity of a single container, in elements
+	std::atomic<int64_t> peak_capacity;
+	//capacity - count at each free, how much of the growth was never used
+	std::atomic<int64_t> slack_bytes_at_free;
+	std::atomic<int64_t> max_slack_bytes_at_free;
+};
+
+namespace detail_
+{
+	inline std::atomic<allocation_stats*>& allocation_stats_head()
+	{
+		static std::atomic<allocation_stats*> head(nullptr);
+		return head;
+	}
+	inline void atomic_max(std::atomic<int64_t>& target, int64_t value)
+	{
+		auto current = target.load(std::memory_order_relaxed);
+		while (current < value && !target.compare_exchange_weak(current, value, std::memory_order_relaxed));
+	}
+	template<class Tag>
+	struct registered_stats : allocation_stats
+	{
+		registered_stats()
+			: allocation_stats()
+		{
+			name = Tag::name();
+			auto& head = allocation_stats_head();
+			next = head.load(std::memory_order_relaxed);
+			while (!head.compare_exchange_weak(next, this, std::memory_order_release, std::memory_order_relaxed));
+		}
+	};
+}
+
+template<class Tag>
+allocation_stats& allocation_stats_for()
+{
+	static detail_::registered_stats<Tag> stats;
+	return stats;
+}
+
+//one line per tag that has been used, nothing when none has
+inline void allocation_report(std::ostream& out)
+{
+	auto head = detail_::allocation_stats_head().load(std::memory_order_acquire);
+	if (!head)
+	{
+		return;
+	}
+	out << "tag, realloc, realloc_exact, free, copies, bytes moved, live bytes, peak live bytes, peak capacity, slack bytes at free, max slack bytes at free" << std::endl;
+	for (auto s = head; s; s = s->next)
+	{
+		out << s->name << ", " << s->realloc_calls << ", " << s->realloc_exact_calls << ", " << s->free_calls << ", "
+			<< s->copies << ", " << s->bytes_moved << ", " << s->live_bytes << ", " << s->peak_live_bytes << ", "
+			<< s->peak_capacity << ", " << s->slack_bytes_at_free << ", " << s->max_slack_bytes_at_free << std::endl;
+	}
+}
+
+//what tracking_allocator names when SG14_TRACK_ALLOCATIONS is defined
+template<class Inner, class Tag>
+struct tracked_allocator
+{
+	template<typename T>
+	struct typed : Inner::template typed<T>
+	{
+		using base = typename Inner::template typed<T>;
+		using base::base;
+
+		void assign(typed&& other, int64_t othersize)
+		{
+			base::assign(std::move(other), othersize);
+		}
+		void assign(const typed& other, int64_t othersize)
+		{
+			base::assign(other, othersize);
+			auto& s = allocation_stats_for<Tag>();
+			s.copies.fetch_add(1, std::memory_order_relaxed);
+			record_capacity(s, 0, othersize);
+		}
+		int64_t realloc_exact(int64_t size, int64_t desired_size, int64_t capacity)
+		{
+			auto result = base::realloc_exact(size, desired_size, capacity);
+			auto& s = allocation_stats_for<Tag>();
+			s.realloc_exact_calls.fetch_add(1, std::memory_order_relaxed);
+			record_realloc(s, size, capacity, result);
+			return result;
+		}
+		int64_t realloc(int64_t size, int64_t desired_size, int64_t capacity)
+		{
+			auto result = base::realloc(size, desired_size, capacity);
+			auto& s = allocation_stats_for<Tag>();
+			s.realloc_calls.fetch_add(1, std::memory_order_relaxed);
+			record_realloc(s, size, capacity, result);
+			return result;
+		}
+		void free(int64_t size, int64_t capacity)
+		{
+			base::free(size, capacity);
+			auto& s = allocation_stats_for<Tag>();
+			s.free_calls.fetch_add(1, std::memory_order_relaxed);
+			auto slack = (capacity - size) * int64_t(sizeof(T));
+			s.slack_bytes_at_free.fetch_add(slack, std::memory_order_relaxed);
+			detail_::atomic_max(s.max_slack_bytes_at_free, slack);
+			record_capacity(s, capacity, 0);
+		}
+
+	private:
+		static void record_realloc(allocation_stats& s, int64_t size, int64_t old_capacity, int64_t new_capacity)
+		{
+			if (new_capacity != old_capacity && size > 0 && new_capacity > 0)
+			{
+				s.bytes_moved.fetch_add(size * int64_t(sizeof(T)), std::memory_order_relaxed);
+			}
+			record_capacity(s, old_capacity, new_capacity);
+		}
+		static void record_capacity(allocation_stats& s, int64_t old_capacity, int64_t new_capacity)
+		{
+			auto live = s.live_bytes.fetch_add((new_capacity - old_capacity) * int64_t(sizeof(T)), std::memory_order_relaxed);
+			detail_::atomic_max(s.peak_live_bytes, live + (new_capacity - old_capacity) * int64_t(sizeof(T)));
+			detail_::atomic_max(s.peak_capacity, new_capacity);
+		}
+	};
+};
+
+namespace detail_
+{
+	template<class Inner, class Tag, bool Enabled>
+	struct select_tracking
+	{
+		using type = Inner;
+	};
+	template<class Inner, class Tag>
+	struct select_tracking<Inner, Tag, true>
+	{
+		using type = tracked_allocator<Inner, Tag>;
+	};
+}
+
+#if defined(SG14_TRACK_ALLOCATIONS)
+constexpr bool allocation_tracking = true;
+#else
+constexpr bool allocation_tracking = false;
+#endif
+
+template<class Inner, class Tag>
+using tracking_allocator = typename detail_::select_tracking<Inner, Tag, allocation_tracking>::type;
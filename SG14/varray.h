@@ -32,7 +32,7 @@ public:
 		:count_(c.size())
 	{
 		capacity_ = allocator_.realloc(0, count_, 0);
-		std::uninitialized_copy(c.begin(), c.end(), begin());
+		stdext::bulk_copy(c.begin(), count_, begin());
 	}
 
 	varray(const varray& other) noexcept(true)
@@ -181,7 +181,7 @@ public:
 
 	bool operator==(span<const T> OtherArray) const
 	{
-		return std::equals(view(), OtherArray);
+		return count_ == int64_t(OtherArray.size()) && stdext::bulk_equal(begin(), OtherArray.begin(), count_);
 	}
 	bool operator!=(span<const T> OtherArray) const
 	{
@@ -190,17 +190,34 @@ public:
 
 	T& insert(const T& item, int64_t index)
 	{
-		push_back(item);
-		auto b = begin();
-		std::rotate(b + index, b + count_ - 1, b + count_);
-		return *(b + index);
+		return emplace(index, item);
 	}
 	T& insert(T&& Item, int64_t index)
 	{
-		push_back(std::move(Item));
-		auto b = begin();
-		std::rotate(b + index, b + count_ - 1, b + count_);
-		return *(b + index);
+		return emplace(index, std::move(Item));
+	}
+	//inserts the items before index, the tail is moved once and capacity grows at most once
+	//items must not refer to elements of this array
+	T* insert(int64_t index, span<const T> items)
+	{
+		auto pos = open_gap(index, items.size());
+		stdext::bulk_copy(items.begin(), items.size(), pos);
+		return pos;
+	}
+	template<class ForwardIt>
+	T* insert(int64_t index, ForwardIt first, ForwardIt last)
+	{
+		auto pos = open_gap(index, std::distance(first, last));
+		std::uninitialized_copy(first, last, pos);
+		return pos;
+	}
+	//the element is built before the gap is opened, so args may refer to elements of this array
+	template<class... Args>
+	T& emplace(int64_t index, Args&&... args)
+	{
+		T item(std::forward<Args>(args)...);
+		auto pos = open_gap(index, 1);
+		return *new(pos) T(std::move(item));
 	}
 
 	template<class... Args >
@@ -230,11 +247,8 @@ public:
 	{
 		grow_capacity(count_ + source.size());
 
-		auto mstart = begin() + count_;
-		auto sstart = source.begin();
-		std::uninitialized_copy_n(sstart, source.size(), mstart);
+		stdext::bulk_copy(source.begin(), source.size(), end());
 		count_ += source.size();
-
 	}
 
 	void operator+=(varray&& source)
@@ -259,6 +273,67 @@ public:
 		}
 	}
 
+	//appends n elements without constructing them and returns them for writing
+	//the caller must construct every element of the returned span before it is read or destroyed
+	span<T> append_uninitialized(int64_t n)
+	{
+		grow_capacity(count_ + n);
+		auto first = end();
+		count_ += n;
+		return span<T>(first, n);
+	}
+	//changes the size without constructing new elements, see append_uninitialized
+	void resize_uninitialized(int64_t new_size)
+	{
+		if (new_size > count_)
+		{
+			append_uninitialized(new_size - count_);
+		}
+		else
+		{
+			erase_from_end(count_ - new_size);
+		}
+	}
+	//new elements are default initialized, leaving trivial types with indeterminate values
+	void resize_default_init(int64_t new_size)
+	{
+		if (new_size > count_)
+		{
+			auto added = append_uninitialized(new_size - count_);
+			stdext::uninitialized_default_construct(added.begin(), added.end());
+		}
+		else
+		{
+			erase_from_end(count_ - new_size);
+		}
+	}
+	void resize(int64_t new_size)
+	{
+		if (new_size > count_)
+		{
+			auto added = append_uninitialized(new_size - count_);
+			stdext::uninitialized_value_construct(added.begin(), added.end());
+		}
+		else
+		{
+			erase_from_end(count_ - new_size);
+		}
+	}
+	//value is copied before growing, so it may refer to an element of this array
+	void resize(int64_t new_size, const T& value)
+	{
+		if (new_size > count_)
+		{
+			T fill(value);
+			auto added = append_uninitialized(new_size - count_);
+			stdext::bulk_fill(added.begin(), added.size(), fill);
+		}
+		else
+		{
+			erase_from_end(count_ - new_size);
+		}
+	}
+
 	void erase(T* at)
 	{
 		auto e = end();
@@ -274,8 +349,7 @@ public:
 	}
 	int64_t erase(const T* first, const T* last)
 	{
-		auto e = end();
-		std::move(last, e, first);
+		std::move(const_cast<T*>(last), end(), const_cast<T*>(first));
 		return erase_from_end(last - first);
 	}
 	void unstable_erase(const T* at)
@@ -284,7 +358,7 @@ public:
 		auto last = b + count_ - 1;
 		if (at != last)
 		{
-			*at = std::move(*last);
+			*const_cast<T*>(at) = std::move(*last);
 		}
 		stdext::destroy_at(last);
 		count_--;
@@ -293,8 +367,39 @@ public:
 	{
 		auto e = end();
 		assert(last >= first && first >= begin() && last <= e);
-		std::move(e - count, e, first);
-		return erase_from_end(last - first);
+		auto count = last - first;
+		auto refill = std::min<int64_t>(count, e - last);
+		std::move(e - refill, e, const_cast<T*>(first));
+		return erase_from_end(count);
+	}
+	//removes every element matching p in a single pass, preserving the order of the rest
+	//a nonzero shrink_divisor is forwarded to shrink_sparse once the removed tail is destroyed
+	template<class Pred>
+	int64_t erase_if(Pred p, int64_t shrink_divisor = 0)
+	{
+		auto erased = erase_from_end(end() - stdext::remove_if(begin(), end(), p));
+		shrink_sparse(shrink_divisor);
+		return erased;
+	}
+	//like erase_if but fills holes from the back, so it moves at most one element per removal
+	template<class Pred>
+	int64_t unstable_erase_if(Pred p, int64_t shrink_divisor = 0)
+	{
+		auto erased = erase_from_end(end() - stdext::unstable_remove_if(begin(), end(), p));
+		shrink_sparse(shrink_divisor);
+		return erased;
+	}
+	//once size falls to 1/divisor of capacity, shrinks capacity to twice the size
+	//the headroom keeps arrays hovering around a size from alternately shrinking and growing
+	bool shrink_sparse(int64_t divisor)
+	{
+		auto target = count_ * 2;
+		if (divisor > 0 && count_ * divisor <= capacity_ && target < capacity_)
+		{
+			capacity_ = allocator_.realloc_exact(count_, target, capacity_);
+			return true;
+		}
+		return false;
 	}
 
 	operator span<T>()
@@ -326,5 +431,38 @@ protected:
 		*this += other;
 	}
 
+	//moves [index, size) up by n and returns the start of the n unconstructed slots left behind
+	T* open_gap(int64_t index, int64_t n)
+	{
+		assert(index >= 0 && index <= count_ && n >= 0);
+		grow_capacity(count_ + n);
+		auto pos = begin() + index;
+		auto e = end();
+		if (e - pos > n)
+		{
+			stdext::uninitialized_move(e - n, e, e);
+			std::move_backward(pos, e - n, e);
+			stdext::destroy(pos, pos + n);
+		}
+		else
+		{
+			stdext::uninitialized_move(pos, e, pos + n);
+			stdext::destroy(pos, e);
+		}
+		count_ += n;
+		return pos;
+	}
+
 
 };
+
+//varray with inline storage for N elements, spilling to the heap beyond that
+template<typename T, uint32_t N>
+using small_varray = varray<T, small_buffer_allocator<N>>;
+
+//spill counts for every small_varray<T, N>, use them to tune N
+template<typename T, uint32_t N>
+small_buffer_stats& small_varray_stats()
+{
+	return small_buffer_allocator<N>::template typed<T>::stats();
+}
@@ -1,7 +1,9 @@
 #pragma once
 #include <memory>
+#include <atomic>
 #include <intrin.h>
 #include "algorithm_ext.h"
+#include "bulk_kernels.h"
 template<uint32_t BufferCount>
 struct buffer_allocator
 {
@@ -21,8 +23,7 @@ struct buffer_allocator
 		}
 		void assign(const typed& other, size_t other_size) noexcept(true)
 		{
-			auto otherdata = other.data();
-			std::uninitialized_copy(otherdata, otherdata + other_size, data());
+			stdext::bulk_copy(other.data(), other_size, data());
 		}
 
 		T* data() const
@@ -56,7 +57,7 @@ struct buffer_allocator
 #pragma intrinsic( _BitScanReverse64)
 namespace math
 {
-	uint64_t ceil_log2(uint64_t a) // ceil(log2(a))
+	inline uint64_t ceil_log2(uint64_t a) // ceil(log2(a))
 	{
 		unsigned long index;
 		if (_BitScanReverse64(&index, a))
@@ -66,20 +67,66 @@ namespace math
 		return 0;
 	}
 
-	int64_t next_power_of_two(uint64_t a)
+	inline int64_t next_power_of_two(uint64_t a)
 	{
 		return int64_t(1) << ceil_log2(a);
 	}
 
+	//floor(log2(a)) for values known at compile time
+	constexpr uint64_t floor_log2(uint64_t a)
+	{
+		return a > 1 ? 1 + floor_log2(a >> 1) : 0;
+	}
+
 }
+//growth policies map (size, desired_size, sizeof(T)) to the capacity to allocate
 template<size_t Min>
 struct grow_default
 {
-	int64_t operator()(int64_t size, int64_t desired_size)
+	int64_t operator()(int64_t size, int64_t desired_size, int64_t = 1)
 	{
 		return (desired_size == 0) ? 0 : ((desired_size < Min) ? Min : math::next_power_of_two(desired_size));
 	}
 };
+//grows by a factor of Num/Den, e.g. grow_geometric<3, 2> for 1.5x
+template<size_t Num, size_t Den, size_t Min = 32>
+struct grow_geometric
+{
+	static_assert(Num > Den && Den > 0, "growth factor must be greater than one");
+	int64_t operator()(int64_t size, int64_t desired_size, int64_t = 1)
+	{
+		if (desired_size == 0)
+		{
+			return 0;
+		}
+		auto grown = size + (size * int64_t(Num - Den) + int64_t(Den) - 1) / int64_t(Den);
+		return std::max<int64_t>(std::max<int64_t>(grown, desired_size), Min);
+	}
+};
+//limits each growth step of Inner to MaxStepBytes, so very large arrays grow linearly
+template<class Inner, size_t MaxStepBytes>
+struct grow_max_step
+{
+	int64_t operator()(int64_t size, int64_t desired_size, int64_t element_size = 1)
+	{
+		Inner g;
+		auto grown = g(size, desired_size, element_size);
+		auto max_step = std::max<int64_t>(MaxStepBytes / element_size, 1);
+		return std::max(desired_size, std::min(grown, size + max_step));
+	}
+};
+//rounds the capacity chosen by Inner up so the allocation fills whole pages
+template<class Inner, size_t PageBytes = 4096>
+struct grow_page_rounded
+{
+	int64_t operator()(int64_t size, int64_t desired_size, int64_t element_size = 1)
+	{
+		Inner g;
+		auto grown = g(size, desired_size, element_size);
+		auto bytes = (grown * element_size + int64_t(PageBytes) - 1) / int64_t(PageBytes) * int64_t(PageBytes);
+		return bytes / element_size;
+	}
+};
 template<class GrowthPolicy = grow_default<32>>
 struct heap_allocator
 {
@@ -95,7 +142,7 @@ struct heap_allocator
 			if (othersize > 0)
 			{
 				data_ = (T*) ::malloc(othersize * sizeof(T));
-				std::uninitialized_copy_n(other.data(), othersize, data_);
+				stdext::bulk_copy(other.data(), othersize, data_);
 			}
 		}
 		void assign(typed&& other, size_t othersize) noexcept(true)
@@ -134,7 +181,7 @@ struct heap_allocator
 		int64_t realloc(int64_t size, int64_t desired_size, int64_t capacity)
 		{
 			GrowthPolicy g;
-			desired_size = g(size, desired_size);
+			desired_size = g(size, desired_size, sizeof(T));
 			return realloc_exact(size, desired_size, capacity);
 		}
 		void free(int64_t size, int64_t capacity)
@@ -160,9 +207,10 @@ struct fallback_allocator
 		typed(const typed& other) = delete;
 		typed(typed&& other) = delete;
 
+		//the elements live in b_ whenever it holds an allocation, whatever their count
 		void assign(typed&& other, int64_t othersize)
 		{
-			if (othersize < other.a_.max_count())
+			if (!other.b_.data())
 			{
 				a_.assign(std::move(other.a_), othersize);
 			}
@@ -171,15 +219,18 @@ struct fallback_allocator
 				b_.assign(std::move(other.b_), othersize);
 			}
 		}
+		//other's elements may be in b_ even when they would fit in a_, so copy from other.data()
 		void assign(const typed& other, int64_t othersize)
 		{
-			if (othersize < other.a_.max_count())
+			if (othersize <= a_.max_count())
 			{
-				a_.assign(other.a_, othersize);
+				a_.realloc_exact(0, othersize, 0);
+				stdext::bulk_copy(other.data(), othersize, a_.data());
 			}
 			else
 			{
-				b_.assign(other.b_, othersize);
+				b_.realloc_exact(0, othersize, 0);
+				stdext::bulk_copy(other.data(), othersize, b_.data());
 			}
 		}
 
@@ -203,7 +254,7 @@ struct fallback_allocator
 				if (bdata)
 				{
 					//needs to be moved from b_
-					std::move(bdata, bdata + old_size, a_.data());
+					stdext::uninitialized_move(bdata, bdata + old_size, a_.data());
 					b_.free(old_size, capacity);
 				}
 				return result;
@@ -212,11 +263,11 @@ struct fallback_allocator
 			{
 				//data must fit into b_
 				auto oldbdata = b_.data();
-				auto result = op(b_, old_size, desired_size, capacity);
+				auto result = op(b_, oldbdata ? old_size : 0, desired_size, capacity);
 				if (!oldbdata)
 				{
 					//data needs to be moved from a_ to b_
-					std::move(a_.data(), a_.data() + old_size, b_.data());
+					stdext::uninitialized_move(a_.data(), a_.data() + old_size, b_.data());
 					a_.free(old_size, capacity);
 				}
 
@@ -249,6 +300,134 @@ struct fallback_allocator
 template<size_t N>
 using bufheap_allocator = fallback_allocator< buffer_allocator<N> >;
 
+struct small_buffer_stats
+{
+	std::atomic<int64_t> spills;
+	std::atomic<int64_t> largest_spill;
+};
+
+//inline storage for BufferCount elements that spills to the heap beyond that
+//unlike bufheap_allocator, data_ always points at the live storage so data() does not branch
+template<uint32_t BufferCount, class GrowthPolicy = grow_default<32>>
+struct small_buffer_allocator
+{
+	template<typename T>
+	struct typed
+	{
+		T* data_;
+
+		typed() noexcept(true)
+			: data_(inline_data())
+		{}
+		typed(typed&&) = delete;
+		typed(const typed&) = delete;
+
+		//shared by every array of this T and BufferCount, counts moves from inline storage to the heap
+		static small_buffer_stats& stats()
+		{
+			static small_buffer_stats s;
+			return s;
+		}
+
+		void assign(typed&& other, int64_t othersize) noexcept(true)
+		{
+			if (other.on_heap())
+			{
+				data_ = other.data_;
+				other.data_ = other.inline_data();
+			}
+			else
+			{
+				stdext::uninitialized_move(other.data_, other.data_ + othersize, data_);
+				stdext::destroy(other.data_, other.data_ + othersize);
+			}
+		}
+		void assign(const typed& other, int64_t othersize) noexcept(true)
+		{
+			if (othersize > BufferCount)
+			{
+				record_spill(othersize);
+				data_ = (T*) ::malloc(othersize * sizeof(T));
+			}
+			stdext::bulk_copy(other.data_, othersize, data_);
+		}
+
+		T* data() const
+		{
+			return data_;
+		}
+		int64_t max_count() const
+		{
+			return std::numeric_limits<int64_t>::max();
+		}
+		bool on_heap() const
+		{
+			return data_ != inline_data();
+		}
+		int64_t realloc_exact(int64_t size, int64_t desired_size, int64_t capacity)
+		{
+			if (desired_size <= BufferCount)
+			{
+				if (on_heap())
+				{
+					stdext::uninitialized_move(data_, data_ + size, inline_data());
+					this->free(size, capacity);
+				}
+				return BufferCount;
+			}
+			if (on_heap() && std::is_trivial<T>::value)
+			{
+				data_ = (T*)::realloc(data_, desired_size * sizeof(T));
+			}
+			else
+			{
+				if (!on_heap())
+				{
+					record_spill(desired_size);
+				}
+				auto new_data = (T*) ::malloc(desired_size * sizeof(T));
+				stdext::uninitialized_move(data_, data_ + size, new_data);
+				this->free(size, capacity);
+				data_ = new_data;
+			}
+			return desired_size;
+		}
+		int64_t realloc(int64_t size, int64_t desired_size, int64_t capacity)
+		{
+			if (desired_size > BufferCount)
+			{
+				GrowthPolicy g;
+				desired_size = std::max<int64_t>(g(size, desired_size, sizeof(T)), BufferCount + 1);
+			}
+			return realloc_exact(size, desired_size, capacity);
+		}
+		void free(int64_t size, int64_t capacity)
+		{
+			stdext::destroy(data_, data_ + size);
+			if (on_heap())
+			{
+				::free(data_);
+			}
+			data_ = inline_data();
+		}
+
+	private:
+		T* inline_data() const
+		{
+			return (T*)std::begin(buffer);
+		}
+		static void record_spill(int64_t size)
+		{
+			auto& s = stats();
+			s.spills.fetch_add(1, std::memory_order_relaxed);
+			auto largest = s.largest_spill.load(std::memory_order_relaxed);
+			while (largest < size && !s.largest_spill.compare_exchange_weak(largest, size, std::memory_order_relaxed));
+		}
+
+		typename std::aligned_storage<sizeof(T), alignof(T)>::type buffer[BufferCount];
+	};
+};
+
 #if 0
 struct example_poly_alloc
 {
@@ -9,6 +9,19 @@ namespace sg14_test
 	void hotmap();
 	//void sort_test();
 	void exposed_ptr_test();
+	void varray_test();
+	void growth_policy_test();
+	void tracking_allocator_test();
+	void rolling_queue_test();
+	void rolling_queue_benchmark();
+	void colony_test();
+	void chunked_stack_test();
+	void slot_map_test();
+	void atomic_exposed_ptr_test();
+	void intrusive_soft_ptr_test();
+	void compact_kernels_test();
+	void multi_partition_test();
+	void parallel_algorithm_test();
 }
 
 #endif
@@ -0,0 +1,174 @@
+#include "SG14_test.h"
+#include "atomic_exposed_ptr.h"
+#include <cassert>
+#include <thread>
+#include <vector>
+namespace
+{
+	std::atomic<int32_t> destroyed(0);
+	struct tracked
+	{
+		int64_t value;
+		tracked(int64_t v)
+			: value(v)
+		{}
+		~tracked()
+		{
+			value = -1;
+			++destroyed;
+		}
+	};
+
+	//a destructor that waits while another thread drops its soft pointer and allocates,
+	//a block handed out again before ~T returns overwrites tag_ under it
+	std::atomic<bool> slow_destroying(false);
+	std::atomic<bool> churned(false);
+	std::atomic<bool> slow_reused(false);
+	std::atomic<int32_t> slow_destroyed(0);
+	struct slow_destructor
+	{
+		std::atomic<int32_t> tag_;
+		bool wait_;
+		slow_destructor(int32_t tag, bool wait)
+			: tag_(tag), wait_(wait)
+		{}
+		~slow_destructor()
+		{
+			auto tag = tag_.load();
+			if (wait_)
+			{
+				slow_destroying = true;
+				for (int i = 0; i < 100000 && !churned; ++i)
+				{
+					std::this_thread::yield();
+				}
+			}
+			if (tag_.load() != tag)
+			{
+				slow_reused = true;
+			}
+			tag_ = -1;
+			++slow_destroyed;
+		}
+	};
+}
+namespace sg14_test
+{
+	void atomic_exposed_ptr_test()
+	{
+		//a live pin defers destruction until it goes away
+		{
+			auto e = atomic_exposed_ptr<tracked>::make(5);
+			auto s = e.soft();
+			assert(e.soft_count() == 2);
+			auto pin = s.lock();
+			assert(pin && pin->value == 5);
+			e = nullptr;
+			assert(destroyed == 0 && pin->value == 5);
+			assert(s.expired() && !s.lock());
+			pin.clear();
+			assert(destroyed == 1);
+			assert(!s.lock());
+		}
+		assert(destroyed == 1);
+
+		//soft pointers outlive the owner, the block goes with the last of them
+		{
+			atomic_soft_ptr<tracked> s;
+			{
+				auto e = atomic_exposed_ptr<tracked>::make(6);
+				s = e.soft();
+			}
+			assert(destroyed == 2 && s.expired() && s.soft_count() == 1);
+		}
+
+		//workers pin concurrently while the owner lets go
+		destroyed = 0;
+		for (int lap = 0; lap < 20; ++lap)
+		{
+			auto e = atomic_exposed_ptr<tracked>::make(lap);
+			auto s = e.soft();
+			std::atomic<bool> go(false);
+			std::vector<std::thread> workers;
+			for (int t = 0; t < 4; ++t)
+			{
+				workers.emplace_back([s, lap, &go]
+				{
+					while (!go)
+					{
+						std::this_thread::yield();
+					}
+					for (int i = 0; i < 1000; ++i)
+					{
+						if (auto pin = s.lock())
+						{
+							assert(pin->value == lap);
+						}
+						else
+						{
+							break;
+						}
+					}
+				});
+			}
+			go = true;
+			std::this_thread::yield();
+			e = nullptr;
+			for (auto& w : workers)
+			{
+				w.join();
+			}
+			assert(s.expired());
+		}
+		assert(destroyed == 20);
+
+		//the last soft pointer is dropped on another thread while ~T runs, on the owner's thread or the last pin's
+		for (int lap = 0; lap < 20; ++lap)
+		{
+			slow_destroying = false;
+			churned = false;
+			auto e = atomic_exposed_ptr<slow_destructor>::make(111, true);
+			std::thread dropper([s = e.soft()]() mutable
+			{
+				while (!slow_destroying)
+				{
+					std::this_thread::yield();
+				}
+				s = nullptr;
+				for (int i = 0; i < 20; ++i)
+				{
+					auto other = atomic_exposed_ptr<slow_destructor>::make(222, false);
+				}
+				churned = true;
+			});
+			if (lap % 2)
+			{
+				std::atomic<bool> pinned(false);
+				std::thread pinner([s = e.soft(), &pinned]() mutable
+				{
+					auto pin = s.lock();
+					s = nullptr;
+					pinned = true;
+					while (pinned)
+					{
+						std::this_thread::yield();
+					}
+				});
+				while (!pinned)
+				{
+					std::this_thread::yield();
+				}
+				e = nullptr;
+				pinned = false;
+				pinner.join();
+			}
+			else
+			{
+				e = nullptr;
+			}
+			dropper.join();
+		}
+		assert(!slow_reused);
+		assert(slow_destroyed == 20 * 21);
+	}
+}
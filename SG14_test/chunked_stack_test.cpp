@@ -0,0 +1,55 @@
+#include "SG14_test.h"
+#include "chunked_stack.h"
+#include <cassert>
+#include <memory>
+#include <vector>
+namespace sg14_test
+{
+	void chunked_stack_test()
+	{
+		chunked_stack<int> s;
+		std::vector<int*> pointers;
+		for (int i = 0; i < 1000; ++i)
+		{
+			pointers.push_back(&s.push(i));
+		}
+		for (int i = 0; i < 1000; ++i)
+		{
+			assert(*pointers[i] == i);
+		}
+		assert(s.size() == 1000 && s.top() == 999);
+
+		//oscillating around a block boundary reuses the spare block
+		while (s.size() > 8)
+		{
+			s.pop();
+		}
+		auto capacity = s.capacity();
+		for (int lap = 0; lap < 100; ++lap)
+		{
+			s.push(8);
+			assert(s.pop() == 8);
+		}
+		assert(s.capacity() == capacity && s.top() == 7);
+		s.shrink_to_fit();
+		assert(s.capacity() == 8);
+
+		int expected = 0;
+		auto copy = s;
+		copy.for_each([&](int i) { assert(i == expected++); });
+		assert(expected == 8);
+
+		chunked_stack<std::unique_ptr<int>> u;
+		for (int i = 0; i < 100; ++i)
+		{
+			u.emplace(new int(i));
+		}
+		auto moved = std::move(u);
+		assert(*moved.pop() == 99 && moved.size() == 99 && u.empty());
+		while (!moved.empty())
+		{
+			moved.pop();
+		}
+		assert(moved.capacity() > 0);
+	}
+}
@@ -0,0 +1,95 @@
+#include "SG14_test.h"
+#include "colony.h"
+#include <algorithm>
+#include <cassert>
+#include <random>
+#include <vector>
+namespace
+{
+	void colony_basic_test()
+	{
+		colony<int> c;
+		std::vector<int*> pointers;
+		for (int i = 0; i < 1000; ++i)
+		{
+			pointers.push_back(&*c.insert(i));
+		}
+		assert(c.size() == 1000 && c.capacity() >= 1000);
+
+		for (auto it = c.begin(); it != c.end(); )
+		{
+			it = (*it & 1) ? c.erase(it) : ++it;
+		}
+		assert(c.size() == 500);
+		for (int i = 0; i < 1000; i += 2)
+		{
+			assert(*pointers[i] == i);
+		}
+		int64_t count = 0;
+		for (auto i : c)
+		{
+			assert((i & 1) == 0);
+			++count;
+		}
+		assert(count == 500);
+
+		//erased slots are reused before growing
+		auto capacity = c.capacity();
+		for (int i = 0; i < 500; ++i)
+		{
+			c.insert(-1);
+		}
+		assert(c.capacity() == capacity && c.size() == 1000);
+
+		const colony<int>& cc = c;
+		assert(std::count(cc.begin(), cc.end(), -1) == 500);
+
+		for (auto it = c.begin(); it != c.end(); )
+		{
+			it = c.erase(it);
+		}
+		assert(c.empty() && c.capacity() == 0 && c.begin() == c.end());
+	}
+
+	//random inserts and erases checked against a plain vector
+	void colony_random_test()
+	{
+		std::mt19937 rng(42);
+		colony<int64_t> c;
+		std::vector<int64_t> model;
+		int64_t next = 0;
+		for (int step = 0; step < 200000; ++step)
+		{
+			if (model.empty() || rng() % 100 < 55)
+			{
+				c.insert(next);
+				model.push_back(next++);
+			}
+			else
+			{
+				auto target = model[rng() % model.size()];
+				auto it = std::find(c.begin(), c.end(), target);
+				assert(it != c.end());
+				c.erase(it);
+				model.erase(std::find(model.begin(), model.end(), target));
+			}
+			if (step % 997 == 0)
+			{
+				std::vector<int64_t> contents(c.begin(), c.end());
+				std::sort(contents.begin(), contents.end());
+				assert(contents == model && int64_t(model.size()) == c.size());
+			}
+		}
+		auto copy = c;
+		auto moved = std::move(c);
+		assert(copy.size() == moved.size() && c.empty());
+	}
+}
+namespace sg14_test
+{
+	void colony_test()
+	{
+		colony_basic_test();
+		colony_random_test();
+	}
+}
@@ -0,0 +1,66 @@
+#include "SG14_test.h"
+#include "algorithm_ext.h"
+#include <algorithm>
+#include <cassert>
+#include <random>
+#include <vector>
+namespace
+{
+	template<class T, class Make>
+	void check_kernels(std::mt19937& rng, Make make)
+	{
+		for (int run = 0; run < 50; ++run)
+		{
+			std::vector<T> data(rng() % 300);
+			for (auto& x : data)
+			{
+				x = make(rng() % 64);
+			}
+			auto cutoff = make(rng() % 64);
+			auto pred = [&](const T& x) { return x < cutoff; };
+
+			auto expected = data;
+			expected.erase(std::remove_if(expected.begin(), expected.end(), pred), expected.end());
+
+			auto stable = data;
+			auto e = stdext::remove_if(stable.data(), stable.data() + stable.size(), pred);
+			assert(std::equal(stable.data(), e, expected.begin(), expected.end()));
+
+			auto unstable = data;
+			e = stdext::unstable_remove_if(unstable.data(), unstable.data() + unstable.size(), pred);
+			//kept elements in front of the result stay where they were, only removed slots are refilled
+			for (auto i = 0; i < e - unstable.data(); ++i)
+			{
+				assert(pred(data[i]) || unstable[i] == data[i]);
+			}
+			std::vector<T> kept(unstable.data(), e);
+			std::sort(kept.begin(), kept.end());
+			std::sort(expected.begin(), expected.end());
+			assert(kept == expected);
+		}
+	}
+}
+namespace sg14_test
+{
+	void compact_kernels_test()
+	{
+		std::mt19937 rng(7);
+		static int64_t slots[64];
+		auto detected = stdext::compact_simd_level().load();
+		for (auto level : { stdext::simd_level::scalar, stdext::simd_level::avx2, stdext::simd_level::avx512 })
+		{
+			if (level > detected)
+			{
+				break;
+			}
+			stdext::compact_simd_level() = level;
+			check_kernels<int32_t>(rng, [](uint32_t i) { return int32_t(i) - 32; });
+			check_kernels<uint16_t>(rng, [](uint32_t i) { return uint16_t(i); });
+			check_kernels<float>(rng, [](uint32_t i) { return float(i) * 0.5f; });
+			check_kernels<double>(rng, [](uint32_t i) { return double(i) - 10.0; });
+			check_kernels<int64_t>(rng, [](uint32_t i) { return int64_t(i) << 40; });
+			check_kernels<int64_t*>(rng, [](uint32_t i) { return slots + i; });
+		}
+		stdext::compact_simd_level() = detected;
+	}
+}
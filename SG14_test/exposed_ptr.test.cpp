@@ -1,4 +1,5 @@
 #include "exposed_ptr.h"
+#include "exposed_pool.h"
 #include "SG14_test.h"
 #include <cassert>
 namespace
@@ -11,6 +12,37 @@ namespace
 			auto l = soft_from(this);
 		}
 	};
+
+	int32_t destroyed = 0;
+	struct tracked
+	{
+		int32_t value = 0;
+		exposed_ptr<tracked, destroy_deferred> child;
+		~tracked()
+		{
+			++destroyed;
+		}
+	};
+
+	int64_t counted_live = 0;
+	template<class T>
+	struct counting_allocator
+	{
+		using value_type = T;
+		counting_allocator() = default;
+		template<class U>
+		counting_allocator(const counting_allocator<U>&) {}
+		T* allocate(size_t n)
+		{
+			++counted_live;
+			return std::allocator<T>().allocate(n);
+		}
+		void deallocate(T* p, size_t n)
+		{
+			--counted_live;
+			std::allocator<T>().deallocate(p, n);
+		}
+	};
 }
 namespace sg14_test
 {
@@ -40,5 +72,103 @@ namespace sg14_test
 		assert(m == nullptr);
 		assert(!m);
 
+		//pooled blocks are reused once the last reference lets go
+		{
+			int* first;
+			{
+				auto e = exposed_ptr<int>::make(1);
+				first = e.get();
+			}
+			auto e = exposed_ptr<int>::make(2);
+			assert(e.get() == first);
+			soft_ptr<int> s = e;
+			e = nullptr;
+			auto f = exposed_ptr<int>::make(3);
+			assert(f.get() != first);
+			s = nullptr;
+			auto g = exposed_ptr<int>::make(4);
+			assert(g.get() == first);
+		}
+
+		//allocator blocks are freed by whichever reference goes last
+		{
+			soft_ptr<exposed_class> s;
+			{
+				auto e = allocate_exposed<exposed_class>(counting_allocator<int>());
+				assert(counted_live == 1);
+				e->value = 7;
+				s = soft_from(e.get());
+				assert(s->value == 7);
+			}
+			assert(!s);
+			assert(counted_live == 1);
+			s = nullptr;
+			assert(counted_live == 0);
+		}
+
+		//deferred destruction invalidates at once and destroys at the next drain
+		{
+			destroy_deferred::reserve(64);
+			auto e = exposed_ptr<tracked, destroy_deferred>::make();
+			e->child = exposed_ptr<tracked, destroy_deferred>::make();
+			soft_ptr<tracked> parent = e;
+			soft_ptr<tracked> child = e->child;
+			e = nullptr;
+			assert(!parent && child && destroyed == 0);
+			assert(destroy_deferred::pending() == 1);
+
+			//the child is retired by its parent's destructor and drained in the same call
+			assert(destroy_deferred::drain() == 2);
+			assert(destroyed == 2 && !child);
+			assert(destroy_deferred::pending() == 0);
+
+			auto f = exposed_ptr<tracked, destroy_deferred>::make();
+			f = nullptr;
+			assert(destroy_deferred::drain() == 1 && destroyed == 3);
+
+			//a reserved list takes a frame's worth without growing
+			for (int i = 0; i < 64; ++i)
+			{
+				exposed_ptr<tracked, destroy_deferred>::make();
+			}
+			assert(destroy_deferred::pending() == 64 && destroy_deferred::drain() == 64 && destroyed == 67);
+		}
+
+		//pooled objects are contiguous and iterated without their dead neighbours
+		{
+			exposed_pool<exposed_class, 16> pool;
+			varray<exposed_ptr<exposed_class>> objects;
+			for (int32_t i = 0; i < 40; ++i)
+			{
+				objects.push_back(pool.make());
+				objects.back()->value = i;
+			}
+			assert(pool.capacity() == 48 && pool.blocks_in_use() == 40);
+			auto s = soft_from(objects[3].get());
+			assert(s->value == 3);
+			for (int32_t i = 0; i < 40; i += 2)
+			{
+				objects[i] = nullptr;
+			}
+			int32_t seen = 0;
+			int32_t last = -1;
+			pool.for_each_live([&](exposed_class& e)
+			{
+				assert(e.value % 2 == 1 && e.value > last);
+				last = e.value;
+				++seen;
+			});
+			assert(seen == 20 && pool.blocks_in_use() == 20);
+			objects[3] = nullptr;
+			assert(!s && pool.blocks_in_use() == 20);
+			s = nullptr;
+			assert(pool.blocks_in_use() == 19);
+			auto d = pool.make<destroy_deferred>();
+			d = nullptr;
+			destroy_deferred::drain();
+			objects.clear();
+			assert(pool.blocks_in_use() == 0);
+		}
+
 	}
 }
\ No newline at end of file
@@ -0,0 +1,82 @@
+#include "SG14_test.h"
+#include "varray.h"
+#include <array>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+
+namespace
+{
+	//non-trivial so growth goes through heap_allocator's malloc/move/free path
+	struct particle
+	{
+		std::array<float, 8> data;
+		particle() = default;
+		particle(const particle&) = default;
+		particle(particle&& other) : data(other.data) {}
+	};
+
+	struct growth_result
+	{
+		int64_t nanoseconds;
+		int64_t peak_bytes;
+		int64_t final_capacity;
+	};
+
+	//peak_bytes is the largest old + new buffer pair live during a reallocation,
+	//the transient footprint of growing to count elements
+	template<class Policy, class T>
+	growth_result measure(int64_t count)
+	{
+		growth_result result = {};
+		{
+			varray<T, heap_allocator<Policy>> v;
+			auto t0 = std::chrono::high_resolution_clock::now();
+			for (int64_t i = 0; i < count; ++i)
+			{
+				v.push_back(T());
+			}
+			auto t1 = std::chrono::high_resolution_clock::now();
+			result.nanoseconds = std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0).count();
+		}
+		{
+			varray<T, heap_allocator<Policy>> v;
+			for (int64_t i = 0; i < count; ++i)
+			{
+				auto old_capacity = v.capacity();
+				v.push_back(T());
+				if (v.capacity() != old_capacity)
+				{
+					result.peak_bytes = std::max<int64_t>(result.peak_bytes, (old_capacity + v.capacity()) * sizeof(T));
+				}
+			}
+			result.final_capacity = v.capacity();
+		}
+		return result;
+	}
+
+	template<class Policy>
+	void run(std::ostream& out, const char* name, int64_t count)
+	{
+		auto r = measure<Policy, particle>(count);
+		out << name << ", " << count << ", " << r.nanoseconds << ", " << r.peak_bytes << ", "
+			<< (r.final_capacity - count) * int64_t(sizeof(particle)) << std::endl;
+	}
+}
+
+void sg14_test::growth_policy_test()
+{
+	std::ofstream out("growth_results.txt");
+	out << "policy, elements, push_back ns, peak bytes, slack bytes" << std::endl;
+	const int64_t page = 4096;
+	const int64_t step = 64 * 1024 * 1024;
+	for (int64_t count = 100000; count <= 25000000; count *= 3)
+	{
+		run<grow_default<32>>(out, "pow2", count);
+		run<grow_geometric<3, 2>>(out, "1.5x", count);
+		run<grow_geometric<5, 4>>(out, "1.25x", count);
+		run<grow_max_step<grow_geometric<3, 2>, step>>(out, "1.5x max 64MB", count);
+		run<grow_page_rounded<grow_geometric<3, 2>, page>>(out, "1.5x page", count);
+		run<grow_page_rounded<grow_max_step<grow_default<32>, step>, page>>(out, "pow2 max 64MB page", count);
+	}
+}
@@ -0,0 +1,58 @@
+#include "SG14_test.h"
+#include "intrusive_soft_ptr.h"
+#include <cassert>
+namespace
+{
+	struct unit : enable_intrusive_soft_from_this
+	{
+		int32_t id = 0;
+		unit(int32_t i)
+			: id(i)
+		{}
+		intrusive_soft_ptr<unit> self()
+		{
+			return soft_from(this);
+		}
+	};
+}
+namespace sg14_test
+{
+	void intrusive_soft_ptr_test()
+	{
+		intrusive_soft_ptr<unit> outlived;
+		{
+			unit on_stack(1);
+			outlived = on_stack.self();
+			auto copy = outlived;
+			assert(outlived->id == 1 && on_stack.soft_count() == 2 && copy.soft_count() == 2);
+			copy = nullptr;
+			assert(on_stack.soft_count() == 1);
+
+			//copies start without references
+			unit other(on_stack);
+			assert(other.soft_count() == 0 && outlived.get() == &on_stack);
+		}
+		assert(!outlived && outlived == nullptr && outlived.soft_count() == 0);
+
+		//references follow elements through relocation and erasure
+		varray<unit> units;
+		units.emplace_back(0);
+		auto first = soft_from(&units[0]);
+		for (int32_t i = 1; i < 100; ++i)
+		{
+			units.emplace_back(i);
+		}
+		auto tenth = soft_from(&units[10]);
+		auto last = soft_from(&units.back());
+		assert(first->id == 0 && first.get() == &units[0]);
+		units.unstable_erase(&units[0]);
+		assert(!first);
+		assert(last->id == 99 && last.get() == &units[0]);
+		units.erase(&units[5]);
+		assert(tenth->id == 10 && tenth.get() == &units[9]);
+		std::swap(units[0], units[9]);
+		assert(last.get() == &units[9] && tenth.get() == &units[0]);
+		units.clear();
+		assert(!tenth && !last);
+	}
+}
@@ -12,7 +12,20 @@ int main(int, char *[])
 	//sg14_test::uninitialized();
 	//sg14_test::hotset();
 	//sg14_test::hotmap();
+	//sg14_test::growth_policy_test();
+	//sg14_test::rolling_queue_benchmark();
 	sg14_test::exposed_ptr_test();
+	sg14_test::varray_test();
+	sg14_test::tracking_allocator_test();
+	sg14_test::rolling_queue_test();
+	sg14_test::colony_test();
+	sg14_test::chunked_stack_test();
+	sg14_test::slot_map_test();
+	sg14_test::atomic_exposed_ptr_test();
+	sg14_test::intrusive_soft_ptr_test();
+	sg14_test::compact_kernels_test();
+	sg14_test::multi_partition_test();
+	sg14_test::parallel_algorithm_test();
 	//sg14_test::sort_test();
 	puts("tests completed");
 
@@ -0,0 +1,58 @@
+#include "SG14_test.h"
+#include "parallel_algorithm.h"
+#include <algorithm>
+#include <cassert>
+#include <memory>
+#include <random>
+#include <vector>
+namespace
+{
+	template<class It>
+	void check_buckets(const varray<It>& bounds, int64_t k, int64_t n)
+	{
+		assert(bounds.size() == k + 1 && bounds.back() - bounds.front() == n);
+		for (int64_t b = 0; b < k; ++b)
+		{
+			assert(std::all_of(bounds[b], bounds[b + 1], [&](auto& e) { return int64_t(*e % k) == b; }));
+		}
+	}
+}
+namespace sg14_test
+{
+	void multi_partition_test()
+	{
+		std::mt19937 rng(3);
+		for (int run = 0; run < 100; ++run)
+		{
+			auto n = int64_t(rng() % 3000);
+			auto k = int64_t(1 + rng() % 12);
+			std::vector<std::unique_ptr<int>> items;
+			for (int64_t i = 0; i < n; ++i)
+			{
+				items.push_back(std::make_unique<int>(rng() % 1000));
+			}
+			auto sorted_values = [&]
+			{
+				std::vector<int> values;
+				for (auto& p : items)
+				{
+					values.push_back(*p);
+				}
+				std::sort(values.begin(), values.end());
+				return values;
+			};
+			auto before = sorted_values();
+			auto classifier = [k](const std::unique_ptr<int>& p) { return *p % k; };
+
+			auto bounds = stdext::multi_partition(items.begin(), items.end(), k, classifier);
+			check_buckets(bounds, k, n);
+			assert(sorted_values() == before);
+
+			std::shuffle(items.begin(), items.end(), rng);
+			auto policy = stdext::parallel_policy{ int64_t(1 + rng() % 4), int64_t(1 + rng() % 500) };
+			bounds = stdext::multi_partition(policy, items.begin(), items.end(), k, classifier);
+			check_buckets(bounds, k, n);
+			assert(sorted_values() == before);
+		}
+	}
+}
@@ -0,0 +1,134 @@
+#include "SG14_test.h"
+#include "parallel_algorithm.h"
+#include <algorithm>
+#include <cassert>
+#include <random>
+#include <string>
+#include <vector>
+namespace
+{
+	enum class pattern
+	{
+		random,
+		none_kept,
+		all_kept,
+		one_kept,
+		tail_block_kept,
+	};
+
+	//which of n elements survive unstable_remove_if, partition keeps the same ones in front
+	std::vector<bool> keep_pattern(pattern kind, int64_t n, std::mt19937& rng)
+	{
+		std::vector<bool> keep(n, false);
+		switch (kind)
+		{
+		case pattern::random:
+		{
+			auto percent = rng() % 101;
+			for (int64_t i = 0; i < n; ++i)
+			{
+				keep[i] = rng() % 100 < percent;
+			}
+			break;
+		}
+		case pattern::none_kept:
+			break;
+		case pattern::all_kept:
+			keep.assign(n, true);
+			break;
+		case pattern::one_kept:
+			if (n > 0)
+			{
+				keep[rng() % n] = true;
+			}
+			break;
+		case pattern::tail_block_kept:
+			for (int64_t i = n - std::min<int64_t>(n, 1 + rng() % 64); i < n; ++i)
+			{
+				keep[i] = true;
+			}
+			break;
+		}
+		return keep;
+	}
+
+	//values encode their index and whether they are kept, strings are long enough to live on the heap
+	int make_value(int64_t i, bool kept, int)
+	{
+		return int(i * 2 + (kept ? 1 : 0));
+	}
+	std::string make_value(int64_t i, bool kept, std::string)
+	{
+		auto s = std::to_string(i * 2 + (kept ? 1 : 0));
+		return std::string(32 - s.size(), '0') + s;
+	}
+	bool is_kept(int v)
+	{
+		return (v & 1) == 1;
+	}
+	bool is_kept(const std::string& v)
+	{
+		return ((v.back() - '0') & 1) == 1;
+	}
+
+	template<class Container>
+	void check_run(const stdext::parallel_policy& policy, const std::vector<bool>& keep)
+	{
+		using value = std::decay_t<decltype(*std::declval<Container&>().begin())>;
+		int64_t n = keep.size();
+		Container items;
+		for (int64_t i = 0; i < n; ++i)
+		{
+			items.push_back(make_value(i, keep[i], value()));
+		}
+		auto expected_kept = std::count(keep.begin(), keep.end(), true);
+		std::vector<value> kept_values;
+		std::vector<value> all_values(items.begin(), items.end());
+		for (auto& v : items)
+		{
+			if (is_kept(v))
+			{
+				kept_values.push_back(v);
+			}
+		}
+		std::sort(all_values.begin(), all_values.end());
+
+		{
+			auto copy = items;
+			auto e = stdext::unstable_remove_if(policy, copy.begin(), copy.end(), [](const value& v) { return !is_kept(v); });
+			assert(e - copy.begin() == expected_kept);
+			std::vector<value> front(copy.begin(), e);
+			std::sort(front.begin(), front.end());
+			assert(front == kept_values);
+		}
+		{
+			auto copy = items;
+			auto e = stdext::partition(policy, copy.begin(), copy.end(), [](const value& v) { return is_kept(v); });
+			assert(e - copy.begin() == expected_kept);
+			assert(std::all_of(copy.begin(), e, [](const value& v) { return is_kept(v); }));
+			assert(std::none_of(e, copy.end(), [](const value& v) { return is_kept(v); }));
+			std::vector<value> whole(copy.begin(), copy.end());
+			std::sort(whole.begin(), whole.end());
+			assert(whole == all_values);
+		}
+	}
+}
+namespace sg14_test
+{
+	void parallel_algorithm_test()
+	{
+		std::mt19937 rng(5);
+		const pattern patterns[] = { pattern::random, pattern::none_kept, pattern::all_kept, pattern::one_kept, pattern::tail_block_kept };
+		for (int run = 0; run < 200; ++run)
+		{
+			stdext::parallel_policy policy;
+			policy.threads = 1 + rng() % 8;
+			policy.min_block = 1 + rng() % 64;
+			auto n = int64_t(rng() % 2000);
+			auto keep = keep_pattern(patterns[run % 5], n, rng);
+			//varray<int> takes the pointer overloads and their compaction kernels inside each block
+			check_run<varray<int>>(policy, keep);
+			check_run<std::vector<std::string>>(policy, keep);
+		}
+	}
+}
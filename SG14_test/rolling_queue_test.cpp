@@ -0,0 +1,201 @@
+#include "SG14_test.h"
+#include "rolling_queue.h"
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+namespace
+{
+	void spsc_single_thread_test()
+	{
+		spsc_rolling_queue<std::unique_ptr<int>> q(5);
+		assert(q.capacity() == 8 && q.empty());
+		for (int i = 0; i < 8; ++i)
+		{
+			assert(q.try_emplace_back(new int(i)));
+		}
+		assert(!q.try_push_back(std::unique_ptr<int>()) && q.size() == 8);
+		std::unique_ptr<int> out[3];
+		assert(q.pop_n(span<std::unique_ptr<int>>(out, 3)) == 3 && *out[2] == 2);
+		assert(q.try_pop_front(out[0]) && *out[0] == 3 && q.size() == 4);
+
+		spsc_rolling_queue<int, buffer_allocator<16>> b(16);
+		int values[20];
+		for (int i = 0; i < 20; ++i)
+		{
+			values[i] = i;
+		}
+		assert(b.push_n(span<const int>(values, 10)) == 10);
+		int popped[10];
+		assert(b.pop_n(span<int>(popped, 10)) == 10 && popped[9] == 9);
+		//wraps around the end of the buffer
+		assert(b.push_n(span<const int>(values, 20)) == 16);
+		assert(b.pop_n(span<int>(popped, 10)) == 10 && popped[0] == 0 && popped[9] == 9);
+		assert(b.pop_n(span<int>(popped, 10)) == 6 && popped[5] == 15 && b.empty());
+	}
+
+	void spsc_threaded_test()
+	{
+		const int64_t count = 1 << 20;
+		spsc_rolling_queue<int64_t> q(1024);
+		std::thread producer([&]()
+		{
+			std::vector<int64_t> batch(100);
+			for (int64_t next = 0; next < count; )
+			{
+				auto n = std::min<int64_t>(batch.size(), count - next);
+				for (int64_t i = 0; i < n; ++i)
+				{
+					batch[i] = next + i;
+				}
+				next += q.push_n(span<const int64_t>(batch.data(), n));
+			}
+		});
+		std::vector<int64_t> batch(77);
+		for (int64_t expected = 0; expected < count; )
+		{
+			auto n = q.pop_n(span<int64_t>(batch.data(), batch.size()));
+			for (int64_t i = 0; i < n; ++i)
+			{
+				assert(batch[i] == expected + i);
+			}
+			expected += n;
+		}
+		producer.join();
+		assert(q.empty());
+	}
+
+	void mpmc_single_thread_test()
+	{
+		mpmc_rolling_queue<std::unique_ptr<int>, buffer_allocator<4>> q(4);
+		for (int lap = 0; lap < 3; ++lap)
+		{
+			for (int i = 0; i < 4; ++i)
+			{
+				assert(q.try_emplace_back(new int(i)));
+			}
+			assert(!q.try_push_back(std::unique_ptr<int>()) && q.size() == 4);
+			std::unique_ptr<int> out;
+			for (int i = 0; i < 4; ++i)
+			{
+				assert(q.try_pop_front(out) && *out == i);
+			}
+			assert(!q.try_pop_front(out) && q.empty());
+		}
+		q.try_emplace_back(new int(5));
+	}
+
+	//every producer pushes its own increasing sequence, so each consumer must see each producer's values in order
+	template<class Queue>
+	void mpmc_threaded_test(Queue& q, int threads, int64_t per_thread)
+	{
+		std::atomic<int64_t> consumed(0);
+		std::atomic<int64_t> sum(0);
+		std::vector<std::thread> workers;
+		for (int p = 0; p < threads; ++p)
+		{
+			workers.emplace_back([&, p]()
+			{
+				for (int64_t i = 0; i < per_thread; )
+				{
+					if (q.try_push_back((int64_t(p) << 32) | i))
+						++i;
+					else
+						std::this_thread::yield();
+				}
+			});
+		}
+		for (int c = 0; c < threads; ++c)
+		{
+			workers.emplace_back([&]()
+			{
+				std::vector<int64_t> last(threads, -1);
+				int64_t value;
+				while (consumed.load(std::memory_order_relaxed) < per_thread * threads)
+				{
+					if (q.try_pop_front(value))
+					{
+						auto producer = value >> 32;
+						auto index = value & 0xffffffff;
+						assert(index > last[producer]);
+						last[producer] = index;
+						sum += index;
+						++consumed;
+					}
+					else
+					{
+						std::this_thread::yield();
+					}
+				}
+			});
+		}
+		for (auto& t : workers)
+		{
+			t.join();
+		}
+		assert(sum == threads * (per_thread * (per_thread - 1) / 2));
+	}
+
+	struct mutex_deque
+	{
+		std::mutex lock_;
+		std::deque<int64_t> items_;
+		bool try_push_back(int64_t item)
+		{
+			std::lock_guard<std::mutex> guard(lock_);
+			items_.push_back(item);
+			return true;
+		}
+		bool try_pop_front(int64_t& out)
+		{
+			std::lock_guard<std::mutex> guard(lock_);
+			if (items_.empty())
+				return false;
+			out = items_.front();
+			items_.pop_front();
+			return true;
+		}
+	};
+
+	template<class Queue>
+	double ops_per_second(Queue& q, int threads, int64_t per_thread)
+	{
+		auto t0 = std::chrono::high_resolution_clock::now();
+		mpmc_threaded_test(q, threads, per_thread);
+		auto t1 = std::chrono::high_resolution_clock::now();
+		auto seconds = std::chrono::duration<double>(t1 - t0).count();
+		//a push and a pop per item
+		return 2.0 * threads * per_thread / seconds;
+	}
+}
+namespace sg14_test
+{
+	void rolling_queue_test()
+	{
+		spsc_single_thread_test();
+		spsc_threaded_test();
+		mpmc_single_thread_test();
+		mpmc_rolling_queue<int64_t> q(64);
+		mpmc_threaded_test(q, 4, 10000);
+	}
+
+	void rolling_queue_benchmark()
+	{
+		std::ofstream out("queue_results.txt");
+		out << "producers and consumers, mpmc_rolling_queue ops/s, mutex std::deque ops/s" << std::endl;
+		const int64_t items = 1 << 22;
+		for (int threads = 1; threads <= 16; threads *= 2)
+		{
+			mpmc_rolling_queue<int64_t> q(1024);
+			mutex_deque d;
+			auto queue_ops = ops_per_second(q, threads, items / threads);
+			auto deque_ops = ops_per_second(d, threads, items / threads);
+			out << threads << ", " << queue_ops << ", " << deque_ops << std::endl;
+		}
+	}
+}
@@ -0,0 +1,124 @@
+#include "SG14_test.h"
+#include "slot_map.h"
+#include "exposed_ptr.h"
+#include "algorithm_ext.h"
+#include <cassert>
+#include <string>
+#include <vector>
+namespace
+{
+	struct entity : enable_slot_from_this<>
+	{
+		int32_t id = 0;
+		std::string name;
+		entity(int32_t i)
+			: id(i), name(std::to_string(i))
+		{}
+	};
+}
+namespace sg14_test
+{
+	void slot_map_test()
+	{
+		slot_map<entity> m;
+		std::vector<slot_handle> handles;
+		for (int32_t i = 0; i < 100; ++i)
+		{
+			handles.push_back(m.emplace(i));
+		}
+		assert(m.size() == 100);
+		for (int32_t i = 0; i < 100; ++i)
+		{
+			assert(m.get(handles[i])->id == i);
+		}
+
+		//erasing packs the survivors and stales only the erased handles
+		for (int32_t i = 0; i < 100; i += 3)
+		{
+			assert(m.erase(handles[i]));
+			assert(!m.erase(handles[i]));
+		}
+		assert(m.size() == 66);
+		for (int32_t i = 0; i < 100; ++i)
+		{
+			auto e = m.get(handles[i]);
+			assert((i % 3 == 0) == (e == nullptr));
+			assert(!e || (e->id == i && e->name == std::to_string(i)));
+		}
+		int64_t visited = 0;
+		for (auto& e : m)
+		{
+			assert(e.id % 3 != 0);
+			assert(m.handle_from(&e) == handles[e.id]);
+			++visited;
+		}
+		assert(visited == m.size());
+
+		//reused slots get a new generation
+		auto reused = m.emplace(1000);
+		assert(reused.index_ == handles[99].index_);
+		assert(reused.generation_ != handles[99].generation_);
+		assert(!m.contains(handles[99]) && m.get(reused)->id == 1000);
+
+		//slot_ref stands in for soft_ptr at call sites, and soft_from(this) hands one out
+		auto r = m.ref_from(m.get(handles[1]));
+		assert(r.handle() == handles[1]);
+		auto s = soft_from(r.get());
+		assert(r && r->id == 1 && s == r && s.handle() == handles[1]);
+		entity outside(7);
+		assert(soft_from(&outside) == nullptr);
+		m.erase(handles[1]);
+		assert(!r && r == nullptr && !s);
+
+		//elements follow the map when it is copied or moved
+		{
+			auto copy = m;
+			auto moved = std::move(copy);
+			auto e = moved.get(handles[2]);
+			assert(e && soft_from(e).handle() == handles[2] && soft_from(e).get() == e);
+		}
+		assert(m.make_ref(slot_handle()) == nullptr);
+
+		//bulk erase patches the handles of moved elements in the same pass
+		std::vector<slot_handle> live;
+		for (auto& e : m)
+		{
+			live.push_back(m.handle_from(&e));
+		}
+		auto erased = m.erase_if([](const entity& e) { return e.id % 2 == 0; });
+		assert(m.size() + erased == int64_t(live.size()));
+		for (auto h : live)
+		{
+			auto e = m.get(h);
+			assert(e ? e->id % 2 == 1 && m.handle_from(e) == h : !m.contains(h));
+		}
+
+		//the algorithm reports every move so an index map can follow along
+		{
+			std::vector<int32_t> values(50);
+			std::vector<int32_t> position_of(50);
+			for (int32_t i = 0; i < 50; ++i)
+			{
+				values[i] = i;
+				position_of[i] = i;
+			}
+			auto kept_end = stdext::unstable_remove_if_with_relocation(values.begin(), values.end(),
+				[](int32_t v) { return v % 3 == 0; },
+				[&](std::vector<int32_t>::iterator, std::vector<int32_t>::iterator to)
+				{
+					position_of[*to] = int32_t(to - values.begin());
+				});
+			assert(kept_end - values.begin() == 33);
+			for (auto it = values.begin(); it != kept_end; ++it)
+			{
+				assert(*it % 3 != 0 && position_of[*it] == it - values.begin());
+			}
+		}
+
+		m.clear();
+		assert(m.empty());
+		assert(!m.contains(handles[2]) && !m.contains(reused));
+		auto h = m.emplace(7);
+		assert(m.get(h)->id == 7 && m.size() == 1);
+	}
+}
@@ -0,0 +1,54 @@
+#define SG14_TRACK_ALLOCATIONS
+#include "SG14_test.h"
+#include "varray.h"
+#include "tracking_allocator.h"
+#include <cassert>
+#include <sstream>
+namespace
+{
+	struct particles_tag
+	{
+		static const char* name() { return "particles"; }
+	};
+	struct names_tag
+	{
+		static const char* name() { return "names"; }
+	};
+}
+namespace sg14_test
+{
+	void tracking_allocator_test()
+	{
+		auto& particles = allocation_stats_for<particles_tag>();
+		{
+			varray<int64_t, tracking_allocator<heap_allocator<grow_default<32>>, particles_tag>> a;
+			for (int i = 0; i < 100; ++i)
+			{
+				a.push_back(i);
+			}
+			assert(particles.realloc_calls == 3 && particles.peak_capacity == 128);
+			assert(particles.bytes_moved == (32 + 64) * 8 && particles.live_bytes == 128 * 8);
+			auto b = a;
+			assert(particles.copies == 1 && particles.live_bytes == 228 * 8 && particles.peak_live_bytes == 228 * 8);
+			b.shrink_to_fit();
+			assert(particles.realloc_exact_calls == 0);
+		}
+		assert(particles.live_bytes == 0 && particles.free_calls == 2 && particles.max_slack_bytes_at_free == 28 * 8);
+
+		varray<char, tracking_allocator<bufheap_allocator<16>, names_tag>> c;
+		c.resize(100);
+		c.clear(0);
+		assert(allocation_stats_for<names_tag>().realloc_exact_calls == 1);
+
+		std::ostringstream report;
+		allocation_report(report);
+		auto text = report.str();
+		assert(text.find("tag, realloc,") == 0);
+		assert(text.find("\nparticles, 3, 0, 2, 1, 768, 0, 1824, 128, 224, 224\n") != std::string::npos);
+		assert(text.find("\nnames, 1, 1, ") != std::string::npos);
+
+		//without SG14_TRACK_ALLOCATIONS nothing is wrapped
+		static_assert(std::is_same<detail_::select_tracking<heap_allocator<grow_default<32>>, particles_tag, false>::type, heap_allocator<grow_default<32>>>::value, "tracking must reduce to Inner when disabled");
+		static_assert(std::is_same<tracking_allocator<heap_allocator<grow_default<32>>, particles_tag>, tracked_allocator<heap_allocator<grow_default<32>>, particles_tag>>::value, "tracking is enabled in this file");
+	}
+}
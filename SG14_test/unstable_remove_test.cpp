@@ -7,6 +7,7 @@
 #include <functional>
 #include <algorithm>
 #include "algorithm_ext.h"
+#include "parallel_algorithm.h"
 #include <cassert>
 #include <fstream>
 #include <memory>
@@ -169,6 +170,77 @@ void iota_test(std::ostream& out)
 	output.print(out);
 
 }
+//median time of the parallel overloads on an iota range of 16M elements as the thread count doubles
+void parallel_scaling_test(std::ostream& out)
+{
+	const size_t N = size_t(1) << 24;
+	auto max_threads = std::max<int64_t>(1, std::thread::hardware_concurrency());
+	out << std::endl << "parallel scaling test " << N << std::endl;
+	out << "threads, unstable_remove_if, partition" << std::endl;
+	for (int64_t threads = 1; threads <= std::max<int64_t>(8, max_threads); threads *= 2)
+	{
+		auto policy = stdext::par.on(threads);
+		std::vector<int64_t> unstable, partition;
+		for (int run = 0; run < 5; ++run)
+		{
+			unstable.push_back(iota_test_n<1>(N, [&](auto& f)
+			{
+				auto e = stdext::unstable_remove_if(policy, f.begin(), f.end(), is_odd);
+				assert(size_t(e - f.begin()) == N / 2 && std::none_of(f.begin(), e, is_odd));
+			}));
+			partition.push_back(iota_test_n<1>(N, [&](auto& f)
+			{
+				auto e = stdext::partition(policy, f.begin(), f.end(), is_even);
+				assert(size_t(e - f.begin()) == N / 2 && std::all_of(f.begin(), e, is_even));
+			}));
+		}
+		std::sort(unstable.begin(), unstable.end());
+		std::sort(partition.begin(), partition.end());
+		out << threads << ", " << unstable[2] << ", " << partition[2] << std::endl;
+	}
+}
+
+//iota ints with every odd value removed, the branchy generic loops against each compaction kernel
+void compact_benchmark(std::ostream& out)
+{
+	const int N = 1 << 20;
+	auto odd = [](int x) { return (x & 1) == 1; };
+	auto run = [&](auto&& f)
+	{
+		std::vector<int64_t> times;
+		std::vector<int> data(N);
+		for (int i = 0; i < 21; ++i)
+		{
+			std::iota(data.begin(), data.end(), 0);
+			auto t0 = std::chrono::high_resolution_clock::now();
+			f(data);
+			auto t1 = std::chrono::high_resolution_clock::now();
+			times.push_back((t1 - t0).count());
+		}
+		std::sort(times.begin(), times.end());
+		return times[times.size() / 2];
+	};
+	auto detected = stdext::compact_simd_level().load();
+	out << std::endl << "compaction test " << N << std::endl;
+	out << "kernel, remove_if, unstable_remove_if" << std::endl;
+	out << "branchy, "
+		<< run([&](auto& v) { stdext::remove_if(v.begin(), v.end(), odd); }) << ", "
+		<< run([&](auto& v) { stdext::unstable_remove_if(v.begin(), v.end(), odd); }) << std::endl;
+	const char* names[] = { "scalar", "avx2", "avx512" };
+	for (auto level : { stdext::simd_level::scalar, stdext::simd_level::avx2, stdext::simd_level::avx512 })
+	{
+		if (level > detected)
+		{
+			break;
+		}
+		stdext::compact_simd_level() = level;
+		out << names[int(level)] << ", "
+			<< run([&](auto& v) { stdext::remove_if(v.data(), v.data() + v.size(), odd); }) << ", "
+			<< run([&](auto& v) { stdext::unstable_remove_if(v.data(), v.data() + v.size(), odd); }) << std::endl;
+	}
+	stdext::compact_simd_level() = detected;
+}
+
 void sg14_test::unstable_remove_test()
 {
 	std::ofstream file_out("results.txt");
@@ -184,4 +256,6 @@ void sg14_test::unstable_remove_test()
 
 	iota_test<1>(file_out);
 	iota_test<32>(file_out);
+	parallel_scaling_test(file_out);
+	compact_benchmark(file_out);
 }
@@ -0,0 +1,510 @@
+#include "SG14_test.h"
+#include "varray.h"
+#include "static_varray.h"
+#include "soa_varray.h"
+#include "cow_varray.h"
+#include "segmented_varray.h"
+#include <thread>
+#include <cassert>
+#include <cstring>
+#include <string>
+namespace
+{
+	struct counted
+	{
+		static int live;
+		int value = 7;
+		counted() { ++live; }
+		counted(const counted& other) : value(other.value) { ++live; }
+		counted(counted&& other) : value(other.value) { ++live; }
+		counted& operator=(const counted&) = default;
+		counted& operator=(counted&&) = default;
+		~counted() { --live; }
+	};
+	int counted::live = 0;
+
+	constexpr int constexpr_static_varray()
+	{
+		static_varray<int, 4> a = { 1, 2 };
+		a.push_back(3);
+		a.try_push_back(4);
+		a.try_push_back(5);
+		int sum = 0;
+		for (auto i : a)
+		{
+			sum += i;
+		}
+		return sum;
+	}
+	static_assert(constexpr_static_varray() == 10, "static_varray must be usable in constant expressions");
+	static_assert(std::is_trivially_copyable<static_varray<int, 16>>::value, "static_varray of trivial types must be trivially copyable");
+
+	void resize_test()
+	{
+		varray<int> a;
+		a.resize(10, 3);
+		assert(a.size() == 10);
+		for (auto& i : a)
+		{
+			assert(i == 3);
+		}
+		a.resize(20);
+		assert(a.size() == 20 && a[19] == 0);
+		a.resize(5);
+		assert(a.size() == 5 && a[4] == 3);
+
+		a.resize_default_init(8);
+		assert(a.size() == 8);
+
+		auto chunk = a.append_uninitialized(4);
+		assert(chunk.size() == 4 && a.size() == 12);
+		const int src[4] = { 1, 2, 3, 4 };
+		memcpy(chunk.begin(), src, sizeof(src));
+		assert(a[8] == 1 && a[11] == 4);
+
+		a.resize_uninitialized(64);
+		assert(a.size() == 64 && a.capacity() >= 64);
+		a.resize_uninitialized(2);
+		assert(a.size() == 2 && a[0] == 3);
+
+		{
+			varray<counted> c;
+			c.resize_default_init(10);
+			assert(counted::live == 10 && c[9].value == 7);
+			c.resize(3);
+			assert(counted::live == 3);
+		}
+		assert(counted::live == 0);
+	}
+
+	//the policies are called directly, growth_policy_test only benchmarks them
+	void growth_policy_check()
+	{
+		grow_default<32> pow2;
+		assert(pow2(0, 0) == 0 && pow2(0, 1) == 32 && pow2(32, 33) == 64 && pow2(0, 100) == 128);
+		grow_geometric<3, 2> geometric;
+		assert(geometric(0, 0) == 0 && geometric(0, 1) == 32 && geometric(32, 33) == 48 && geometric(100, 500) == 500);
+		//the growth step rounds up
+		grow_geometric<3, 2, 1> unclamped;
+		assert(unclamped(3, 4) == 5 && unclamped(1, 2) == 2);
+
+		grow_max_step<grow_default<32>, 4096> stepped;
+		grow_page_rounded<grow_default<32>, 4096> paged;
+		const int64_t element_sizes[] = { 1, 8, 24, 4096, 10000 };
+		for (auto element_size : element_sizes)
+		{
+			auto max_step = std::max<int64_t>(4096 / element_size, 1);
+			for (int64_t size = 0; size < 5000; size += 1 + size / 4)
+			{
+				for (auto desired : { size + 1, size * 2 + 1, size * 9 + 1 })
+				{
+					auto inner = pow2(size, desired, element_size);
+					auto step = stepped(size, desired, element_size);
+					assert(step >= desired && step <= inner);
+					assert(step == desired || step - size <= max_step);
+
+					auto page = paged(size, desired, element_size);
+					auto page_bytes = (inner * element_size + 4095) / 4096 * 4096;
+					assert(page >= inner && page * element_size <= page_bytes && (page + 1) * element_size > page_bytes);
+					assert(4096 % element_size != 0 || page * element_size % 4096 == 0);
+				}
+			}
+		}
+		assert(stepped(100, 0, 8) == 0 && paged(100, 0, 8) == 0);
+	}
+
+	void insert_test()
+	{
+		varray<int> a = { 0, 1, 2, 7, 8 };
+		const int mid[3] = { 3, 4, 5 };
+		a.insert(3, span<const int>(mid, 3));
+		a.emplace(6, 6);
+		assert(a.size() == 9);
+		for (int i = 0; i < 9; ++i)
+		{
+			assert(a[i] == i);
+		}
+		const int head[2] = { -2, -1 };
+		a.insert(0, std::begin(head), std::end(head));
+		a.insert(a.size(), std::begin(head), std::end(head));
+		a.insert(42, 9);
+		assert(a.size() == 14 && a[0] == -2 && a[9] == 42 && a[10] == 7 && a[13] == -1);
+
+		{
+			varray<counted> c;
+			c.resize(4);
+			counted big[6];
+			c.insert(1, span<const counted>(big, 6));
+			c.emplace(2);
+			assert(c.size() == 11 && counted::live == 17);
+		}
+		assert(counted::live == 0);
+
+		//arguments aliasing an element that the gap shifts or that a reallocation moves
+		{
+			varray<int> b = { 0, 1, 2, 3, 4, 5, 6, 7 };
+			b.grow_capacity(64);
+			b.insert(b[5], 2);
+			const int expected[9] = { 0, 1, 5, 2, 3, 4, 5, 6, 7 };
+			assert(b == span<const int>(expected, 9));
+			varray<std::string> s;
+			s.grow_capacity_exact(3);
+			s.push_back("a");
+			s.push_back("b");
+			s.push_back("c");
+			s.insert(s[2], 0);
+			s.emplace(1, s[3]);
+			assert(s.size() == 5 && s[0] == "c" && s[1] == "c" && s[2] == "a" && s[4] == "c");
+			s.resize(200, s[2]);
+			assert(s.size() == 200 && s[199] == "a" && s[5] == "a");
+		}
+	}
+
+	void erase_if_test()
+	{
+		varray<int> a;
+		for (int i = 0; i < 1000; ++i)
+		{
+			a.push_back(i);
+		}
+		auto is_odd = [](int i) { return (i & 1) == 1; };
+		assert(a.erase_if(is_odd) == 500);
+		for (int i = 0; i < 500; ++i)
+		{
+			assert(a[i] == i * 2);
+		}
+		auto capacity = a.capacity();
+		assert(a.unstable_erase_if([](int i) { return i >= 100; }, 4) == 450);
+		assert(a.size() == 50 && a.capacity() == 100 && a.capacity() < capacity);
+		for (auto i : a)
+		{
+			assert(i < 100 && !is_odd(i));
+		}
+		assert(!a.shrink_sparse(4));
+
+		auto refill = a[40];
+		a.unstable_erase(a.begin() + 10, a.begin() + 20);
+		assert(a.size() == 40 && a[10] == refill);
+		auto kept = a[34];
+		a.unstable_erase(a.begin() + 35, a.end());
+		assert(a.size() == 35 && a[34] == kept);
+
+		{
+			varray<counted> c;
+			c.resize(64);
+			for (int i = 0; i < 64; ++i)
+			{
+				c[i].value = i;
+			}
+			c.unstable_erase_if([](const counted& e) { return e.value % 3 != 0; });
+			assert(c.size() == 22 && counted::live == 22);
+		}
+		assert(counted::live == 0);
+	}
+
+	void small_varray_test()
+	{
+		small_varray<int, 8> a;
+		assert(a.capacity() == 0);
+		for (int i = 0; i < 8; ++i)
+		{
+			a.push_back(i);
+		}
+		assert(a.capacity() == 8 && (small_varray_stats<int, 8>().spills == 0));
+		a.push_back(8);
+		assert(a.capacity() > 8 && (small_varray_stats<int, 8>().spills == 1));
+		for (int i = 0; i < 9; ++i)
+		{
+			assert(a[i] == i);
+		}
+		a.resize(4);
+		a.shrink_to_fit();
+		assert(a.capacity() == 8 && a[3] == 3);
+
+		small_varray<int, 8> b = std::move(a);
+		assert(b.size() == 4 && b[3] == 3 && a.size() == 0);
+
+		{
+			auto& stats = small_varray_stats<counted, 4>();
+			auto spills = stats.spills.load();
+			small_varray<counted, 4> c;
+			c.resize(20);
+			//copying a spilled array spills the copy, moving it takes the heap buffer along
+			small_varray<counted, 4> d = c;
+			assert(stats.spills == spills + 2);
+			small_varray<counted, 4> e = std::move(c);
+			c.resize(2);
+			assert(stats.spills == spills + 2);
+			assert(counted::live == 42 && d.size() == 20 && e.size() == 20);
+			auto largest = small_varray_stats<counted, 4>().largest_spill.load();
+			assert(largest >= 20);
+		}
+		assert(counted::live == 0);
+
+		{
+			varray<counted, bufheap_allocator<4>> f;
+			for (int i = 0; i < 10; ++i)
+			{
+				f.push_back(counted());
+			}
+			f.resize(4);
+			f.shrink_to_fit();
+			varray<counted, bufheap_allocator<4>> g = std::move(f);
+			assert(counted::live == 4 && g.size() == 4);
+		}
+		assert(counted::live == 0);
+
+		//copying from an array whose elements stayed on the heap after shrinking below the buffer size
+		{
+			varray<std::string, bufheap_allocator<4>> h;
+			for (int i = 0; i < 10; ++i)
+			{
+				h.push_back(std::string(32, char('a' + i)));
+			}
+			h.resize(3);
+			varray<std::string, bufheap_allocator<4>> copy = h;
+			assert(copy.size() == 3 && copy[0] == h[0] && copy[1] == h[1] && copy[2] == h[2]);
+		}
+	}
+
+	//one body for both array types, so switching an alias between them keeps compiling and behaving the same
+	template<class Array>
+	void shared_api_test()
+	{
+		Array a;
+		a.grow_capacity(16);
+		a.grow_capacity_exact(16);
+		a.push_back("c");
+		a.push_front("a");
+		a.insert(std::string("b"), 1);
+		a.emplace(3, "d");
+		const std::string tail[2] = { "e", "f" };
+		a.insert(a.size(), span<const std::string>(tail, 2));
+		a.insert(0, std::begin(tail), std::end(tail));
+		assert(a.size() == 8 && a[0] == "e" && a[2] == "a" && a[5] == "d" && a[7] == "f");
+		assert(a.pop_front() == "e" && a.pop_back() == "f");
+		a.erase(a.begin(), a.begin() + 1);
+		a.unstable_erase(a.begin(), a.begin() + 1);
+		assert(a.size() == 4 && a[0] == "e" && a[3] == "d");
+		a.resize(6, "x");
+		a.resize_default_init(7);
+		a.resize_uninitialized(6);
+		a.erase_if([](const std::string& v) { return v == "x"; }, 4);
+		a.unstable_erase_if([](const std::string& v) { return v == "e"; }, 4);
+		a.shrink_to_fit();
+		a.shrink_sparse(4);
+		assert(a.size() == 3 && a[0] == "d" && a[1] == "b" && a[2] == "c");
+		a.clear(16);
+		assert(a.size() == 0);
+	}
+
+	void static_varray_test()
+	{
+		shared_api_test<varray<std::string>>();
+		shared_api_test<static_varray<std::string, 16>>();
+
+		static_varray<int, 8> a;
+		for (int i = 0; i < 8; ++i)
+		{
+			assert(a.try_push_back(i));
+		}
+		assert(!a.try_push_back(8) && a.size() == 8 && a.slack() == 0);
+		a.unstable_erase_if([](int i) { return (i & 1) == 1; });
+		assert(a.size() == 4);
+		a.erase(a.begin());
+		assert(a.size() == 3 && a.pop_back() + a.pop_back() + a.pop_back() == 12);
+
+		static_varray<int, 8> b = { 5, 5, 5 };
+		auto c = b;
+		c.resize(8, 5);
+		c.resize(3);
+		assert(c == b && c != a);
+		static_varray<int, 8> g = { 1, 3 };
+		g.insert(2, 1);
+		g.emplace(0, 0);
+		g.push_front(g[3]);
+		const int expected[5] = { 3, 0, 1, 2, 3 };
+		assert(g == span<const int>(expected, 5));
+
+		{
+			static_varray<counted, 8> e;
+			e.resize(6);
+			static_varray<counted, 8> f = e;
+			f.erase_if([](const counted&) { return true; });
+			f = std::move(e);
+			assert(counted::live == 12 && f.size() == 6);
+			assert(f.try_emplace_back() && counted::live == 13);
+		}
+		assert(counted::live == 0);
+	}
+
+	void bulk_test()
+	{
+		varray<int> a;
+		a.resize(1000, 9);
+		varray<int> b = a;
+		assert(a == b);
+		b[999] = 8;
+		assert(a != b && a.view() != b.view());
+		b.resize(999);
+		a.resize(999);
+		assert(a.view() == b.view());
+
+		varray<char> c;
+		c.resize(77, 'x');
+		varray<int64_t> d;
+		d.resize(33, -1);
+		d += span<const int64_t>(d.begin(), 3);
+		assert(c.size() == 77 && c[76] == 'x' && d.size() == 36 && d[35] == -1);
+
+		varray<float> e = { 0.0f, 1.0f };
+		varray<float> f = { -0.0f, 1.0f };
+		assert(e == f);
+
+		{
+			varray<counted> g;
+			g.resize(10, counted());
+			varray<counted> h = g;
+			h += g;
+			assert(counted::live == 30);
+		}
+		assert(counted::live == 0);
+	}
+
+	void soa_varray_test()
+	{
+		soa_varray<float, int, counted> a;
+		for (int i = 0; i < 100; ++i)
+		{
+			assert(a.push_back(float(i), i * 2, counted()) == i);
+		}
+		assert(a.size() == 100 && a.capacity() >= 100 && counted::live == 100);
+		auto ints = a.column<1>();
+		assert(ints.size() == 100 && ints[99] == 198);
+
+		a.erase_if([](float, int, const counted&) { return false; });
+		assert(a.size() == 100);
+		a.erase_if([](float f, int, const counted&) { return f >= 50.0f; });
+		assert(a.size() == 50 && counted::live == 50);
+		for (int i = 0; i < 50; ++i)
+		{
+			assert(a.get<0>(i) == float(i) && a.get<1>(i) == i * 2);
+		}
+		a.unstable_erase_if([](float, int i, const counted&) { return (i % 4) == 0; });
+		assert(a.size() == 25 && counted::live == 25);
+		for (int i = 0; i < a.size(); ++i)
+		{
+			assert(a.get<1>(i) == int(a.get<0>(i)) * 2 && (a.get<1>(i) % 4) != 0);
+		}
+		a.unstable_erase(0);
+		auto b = a;
+		auto c = std::move(a);
+		assert(b.size() == 24 && c.size() == 24 && a.size() == 0 && counted::live == 48);
+		c.clear();
+		assert(counted::live == 24);
+
+		basic_soa_varray<heap_allocator<grow_page_rounded<grow_default<32>>>, char, double> d;
+		for (int i = 0; i < 1000; ++i)
+		{
+			d.push_back('a', double(i));
+		}
+		assert(d.column<1>()[999] == 999.0);
+	}
+
+	void cow_varray_test()
+	{
+		cow_varray<int> a = { 1, 2, 3 };
+		auto snapshot = a;
+		assert(snapshot.begin() == a.begin() && a.use_count() == 2);
+		a.push_back(4);
+		assert(snapshot.begin() != a.begin() && a.unique() && snapshot.unique());
+		assert(a.size() == 4 && snapshot.size() == 3 && snapshot != a.view());
+
+		varray<int> source;
+		source.resize(10000, 1);
+		cow_varray<int> published(std::move(source));
+		std::thread reader([copy = published]()
+		{
+			for (auto i : copy)
+			{
+				assert(i == 1);
+			}
+		});
+		for (int i = 0; i < 1000; ++i)
+		{
+			published.edit()[i] = 2;
+		}
+		reader.join();
+		assert(published.unique() && published[999] == 2);
+
+		{
+			cow_varray<counted> c;
+			c.emplace_back();
+			cow_varray<counted> d = c;
+			d.clear();
+			assert(counted::live == 1 && d.size() == 0 && c.size() == 1);
+			d = c;
+			d.edit().resize(3);
+			assert(counted::live == 4);
+		}
+		assert(counted::live == 0);
+	}
+
+	void segmented_varray_test()
+	{
+		segmented_varray<int, 16> a;
+		a.push_back(0);
+		int* first = &a[0];
+		for (int i = 1; i < 100; ++i)
+		{
+			a.push_back(i);
+		}
+		assert(first == &a[0] && a.size() == 100 && a.capacity() == 112 && a.chunk_count() == 7);
+		int64_t expected = 0;
+		a.for_each_chunk([&](span<int> items)
+		{
+			for (auto i : items)
+			{
+				assert(i == expected++);
+			}
+		});
+		assert(expected == 100 && a.chunk_view(6).size() == 4);
+
+		assert(a.pop_back() == 99 && a.back() == 98);
+		a.erase_from_end(50);
+		a.shrink_to_fit();
+		assert(a.size() == 49 && a.capacity() == 64);
+
+		segmented_varray<int, 16> b = a;
+		a.clear();
+		assert(b.size() == 49 && b[48] == 48 && a.size() == 0);
+
+		{
+			segmented_varray<counted, 4, buffer_allocator<4>> c;
+			for (int i = 0; i < 10; ++i)
+			{
+				c.emplace_back();
+			}
+			auto d = std::move(c);
+			auto e = d;
+			assert(counted::live == 20 && c.size() == 0 && e.size() == 10);
+		}
+		assert(counted::live == 0);
+	}
+}
+namespace sg14_test
+{
+	void varray_test()
+	{
+		resize_test();
+		growth_policy_check();
+		insert_test();
+		erase_if_test();
+		small_varray_test();
+		static_varray_test();
+		bulk_test();
+		soa_varray_test();
+		cow_varray_test();
+		segmented_varray_test();
+	}
+}